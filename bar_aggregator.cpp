@@ -0,0 +1,161 @@
+#include "bar_aggregator.h"
+
+#include <algorithm>
+
+BarAggregator::BarAggregator(const size_t capacity) : m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+size_t BarAggregator::GetCapacity() const noexcept
+{
+    return m_capacity;
+}
+
+uint32_t BarAggregator::GetInstrument(const std::string& instrument_name)
+{
+    const auto existing = m_instrument_index.find(instrument_name);
+    if (existing != m_instrument_index.end())
+    {
+        return existing->second;
+    }
+
+    const auto instrument = static_cast<uint32_t>(m_series.size() / INTERVAL_COUNT);
+    const size_t length = 2 * m_capacity;
+    for (size_t interval = 0; interval < INTERVAL_COUNT; ++interval)
+    {
+        BarSeries& series = m_series.emplace_back();
+        series.start_time.resize(length);
+        series.open.resize(length);
+        series.high.resize(length);
+        series.low.resize(length);
+        series.close.resize(length);
+        series.volume.resize(length);
+        series.vwap.resize(length);
+        series.imbalance.resize(length);
+        series.trade_count.resize(length);
+    }
+    m_instrument_index.emplace(instrument_name, instrument);
+    return instrument;
+}
+
+void BarAggregator::OnTrade(const Trade& trade)
+{
+    if (trade.amount <= 0.0 || trade.timestamp < 0)
+    {
+        return;
+    }
+    const size_t first = static_cast<size_t>(GetInstrument(trade.instrument_name)) * INTERVAL_COUNT;
+    for (size_t interval = 0; interval < INTERVAL_COUNT; ++interval)
+    {
+        Update(m_series[first + interval], INTERVAL_MS[interval], trade);
+    }
+}
+
+void BarAggregator::Update(BarSeries& series, const int64_t interval_ms, const Trade& trade)
+{
+    const int64_t start_time = trade.timestamp - trade.timestamp % interval_ms;
+    if (series.count == 0)
+    {
+        Open(series, start_time, trade.price);
+    }
+    else
+    {
+        const int64_t current = series.start_time[series.head];
+        if (start_time > current)
+        {
+            // Flat bars for the intervals nobody traded in; more than a ring's worth would be
+            // overwritten anyway
+            const auto skipped = static_cast<size_t>((start_time - current) / interval_ms - 1);
+            const size_t empty = std::min(skipped, m_capacity - 1);
+            const double previous_close = series.close[series.head];
+            for (size_t bar = empty; bar > 0; --bar)
+            {
+                Open(series, start_time - static_cast<int64_t>(bar) * interval_ms, previous_close);
+            }
+            Open(series, start_time, trade.price);
+        }
+        // A trade stamped before the forming bar is late, not a reason to reopen history; it is
+        // counted in the forming bar
+    }
+    Store(series, trade.price, trade.amount, trade.direction == "buy");
+}
+
+// Starts a new bar at the ring's next position, overwriting the oldest once the ring is full
+void BarAggregator::Open(BarSeries& series, const int64_t start_time, const double price)
+{
+    if (series.count > 0)
+    {
+        series.head = series.head + 1 == m_capacity ? 0 : series.head + 1;
+    }
+    series.count = std::min(series.count + 1, m_capacity);
+    series.notional = 0.0;
+    series.buy_volume = 0.0;
+    series.sell_volume = 0.0;
+
+    for (const size_t index : {series.head, series.head + m_capacity})
+    {
+        series.start_time[index] = start_time;
+        series.open[index] = price;
+        series.high[index] = price;
+        series.low[index] = price;
+        series.close[index] = price;
+        series.volume[index] = 0.0;
+        series.vwap[index] = price;
+        series.imbalance[index] = 0.0;
+        series.trade_count[index] = 0;
+    }
+}
+
+// Folds one trade into the forming bar, in both of its copies
+void BarAggregator::Store(BarSeries& series, const double price, const double amount, const bool is_buy)
+{
+    series.notional += price * amount;
+    (is_buy ? series.buy_volume : series.sell_volume) += amount;
+
+    const size_t primary = series.head;
+    const double high = std::max(series.high[primary], price);
+    const double low = std::min(series.low[primary], price);
+    const double volume = series.volume[primary] + amount;
+    const double vwap = series.notional / volume;
+    const double imbalance = (series.buy_volume - series.sell_volume) / volume;
+    const uint32_t trade_count = series.trade_count[primary] + 1;
+
+    for (const size_t index : {primary, primary + m_capacity})
+    {
+        series.high[index] = high;
+        series.low[index] = low;
+        series.close[index] = price;
+        series.volume[index] = volume;
+        series.vwap[index] = vwap;
+        series.imbalance[index] = imbalance;
+        series.trade_count[index] = trade_count;
+    }
+}
+
+bool BarAggregator::GetBars(const std::string& instrument_name, const BarInterval interval,
+                            const size_t count, BarSlice& slice) const
+{
+    const auto instrument = m_instrument_index.find(instrument_name);
+    if (instrument == m_instrument_index.end())
+    {
+        slice = BarSlice{};
+        return false;
+    }
+    const BarSeries& series =
+        m_series[static_cast<size_t>(instrument->second) * INTERVAL_COUNT + static_cast<size_t>(interval)];
+
+    // The run ending at the forming bar's second copy never leaves the doubled columns
+    const size_t size = std::min(count, series.count);
+    const size_t first = series.head + m_capacity + 1 - size;
+    slice.start_time = series.start_time.data() + first;
+    slice.open = series.open.data() + first;
+    slice.high = series.high.data() + first;
+    slice.low = series.low.data() + first;
+    slice.close = series.close.data() + first;
+    slice.volume = series.volume.data() + first;
+    slice.vwap = series.vwap.data() + first;
+    slice.imbalance = series.imbalance.data() + first;
+    slice.trade_count = series.trade_count.data() + first;
+    slice.size = size;
+    return true;
+}
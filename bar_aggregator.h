@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exchange_types.h"
+
+enum class BarInterval
+{
+    ONE_SECOND,
+    ONE_MINUTE,
+    FIVE_MINUTES,
+    ONE_HOUR
+};
+
+// Column views of the most recent bars of one series, oldest first; the last bar is still forming.
+// The pointers index straight into the aggregator's storage and stay valid until its next OnTrade
+// for that instrument.
+struct BarSlice
+{
+    const int64_t* start_time{nullptr};  // Bucket start, ms since epoch
+    const double* open{nullptr};
+    const double* high{nullptr};
+    const double* low{nullptr};
+    const double* close{nullptr};
+    const double* volume{nullptr};
+    const double* vwap{nullptr};
+    const double* imbalance{nullptr};  // (taker buy - taker sell volume) / volume, in [-1, 1]
+    const uint32_t* trade_count{nullptr};
+    size_t size{0};
+};
+
+// Rolls trades from the trades.{instrument} channel into 1s, 1m, 5m and 1h bars per instrument,
+// with VWAP and trade-flow imbalance, updated incrementally as each trade arrives.
+//
+// Every series keeps its last `capacity` bars in columnar rings, one array per field. Each bar is
+// written twice, at i and i + capacity, so the newest N bars are always one contiguous run in
+// every column and GetBars hands out pointers instead of copying. Intervals without trades get
+// flat, zero-volume bars so the series stays evenly spaced. Single-threaded.
+class BarAggregator
+{
+  private:
+    static constexpr size_t INTERVAL_COUNT = 4;
+    static constexpr int64_t INTERVAL_MS[INTERVAL_COUNT] = {1000, 60 * 1000, 5 * 60 * 1000, 60 * 60 * 1000};
+
+    struct BarSeries
+    {
+        // Columns are 2 * capacity long; see Store
+        std::vector<int64_t> start_time;
+        std::vector<double> open;
+        std::vector<double> high;
+        std::vector<double> low;
+        std::vector<double> close;
+        std::vector<double> volume;
+        std::vector<double> vwap;
+        std::vector<double> imbalance;
+        std::vector<uint32_t> trade_count;
+
+        size_t head{0};   // Ring position of the forming bar
+        size_t count{0};  // Bars held, forming bar included
+
+        // Running sums for the forming bar, which the columns only hold as ratios
+        double notional{0.0};
+        double buy_volume{0.0};
+        double sell_volume{0.0};
+    };
+
+    size_t m_capacity;
+    std::unordered_map<std::string, uint32_t> m_instrument_index;
+    std::vector<BarSeries> m_series;  // INTERVAL_COUNT per instrument, in BarInterval order
+
+    uint32_t GetInstrument(const std::string& instrument_name);
+    void Update(BarSeries& series, int64_t interval_ms, const Trade& trade);
+    void Open(BarSeries& series, int64_t start_time, double price);
+    void Store(BarSeries& series, double price, double amount, bool is_buy);
+
+  public:
+    // Capacity is the number of bars kept per instrument and interval
+    explicit BarAggregator(size_t capacity);
+
+    void OnTrade(const Trade& trade);
+
+    // The last `count` bars, or as many as exist. False if the instrument has not traded.
+    bool GetBars(const std::string& instrument_name, BarInterval interval, size_t count,
+                 BarSlice& slice) const;
+
+    size_t GetCapacity() const noexcept;
+};
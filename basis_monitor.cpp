@@ -0,0 +1,294 @@
+#include "basis_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr double NOT_AVAILABLE = std::numeric_limits<double>::quiet_NaN();
+constexpr uint32_t ALL_METRICS = ~0u;
+
+constexpr uint32_t Bit(const BasisMetric metric) noexcept
+{
+    return 1u << static_cast<uint32_t>(metric);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t DaysFromCivil(int64_t year, const int64_t month, const int64_t day) noexcept
+{
+    year -= month <= 2 ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+}  // namespace
+
+int64_t BasisMonitor::ParseExpiry(const std::string_view instrument_name) noexcept
+{
+    const size_t dash = instrument_name.find('-');
+    if (dash == std::string_view::npos || dash == 0)
+    {
+        return -1;
+    }
+    const std::string_view suffix = instrument_name.substr(dash + 1);
+    if (suffix == "PERPETUAL")
+    {
+        return 0;
+    }
+
+    // DMMMYY or DDMMMYY; options carry a strike and type after a further dash and do not match
+    const size_t day_digits = suffix.size() == 6 ? 1 : suffix.size() == 7 ? 2 : 0;
+    if (day_digits == 0)
+    {
+        return -1;
+    }
+    static constexpr std::string_view MONTHS[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                                  "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    const auto digit = [&suffix](const size_t position) -> int64_t
+    { return suffix[position] >= '0' && suffix[position] <= '9' ? suffix[position] - '0' : -1; };
+
+    int64_t day = 0;
+    for (size_t position = 0; position < day_digits; ++position)
+    {
+        if (digit(position) < 0)
+        {
+            return -1;
+        }
+        day = day * 10 + digit(position);
+    }
+    const auto month = std::find(std::begin(MONTHS), std::end(MONTHS), suffix.substr(day_digits, 3));
+    const int64_t tens = digit(day_digits + 3);
+    const int64_t units = digit(day_digits + 4);
+    if (month == std::end(MONTHS) || tens < 0 || units < 0 || day < 1 || day > 31)
+    {
+        return -1;
+    }
+    const int64_t days = DaysFromCivil(2000 + tens * 10 + units, month - std::begin(MONTHS) + 1, day);
+    return (days * 24 + EXPIRY_HOUR_UTC) * 60 * 60 * 1000;
+}
+
+void BasisMonitor::AddEventHandler(BasisEventHandler handler)
+{
+    m_handlers.push_back(std::move(handler));
+}
+
+bool BasisMonitor::FindOrAddRow(const std::string& instrument_name, RowRef& ref)
+{
+    const auto existing = m_rows.find(instrument_name);
+    if (existing != m_rows.end())
+    {
+        ref = existing->second;
+        return true;
+    }
+    const int64_t expiry = ParseExpiry(instrument_name);
+    if (expiry < 0)
+    {
+        return false;
+    }
+
+    const std::string currency = instrument_name.substr(0, instrument_name.find('-'));
+    auto table_index = m_currency_index.find(currency);
+    if (table_index == m_currency_index.end())
+    {
+        table_index = m_currency_index.emplace(currency, static_cast<uint32_t>(m_tables.size())).first;
+        m_tables.emplace_back();
+    }
+    CurrencyTable& table = m_tables[table_index->second];
+
+    const auto position = std::upper_bound(table.expiry.begin(), table.expiry.end(), expiry);
+    const auto row = static_cast<size_t>(position - table.expiry.begin());
+    InsertRow(table, row, instrument_name, expiry);
+    table.has_perpetual = table.has_perpetual || expiry == 0;
+
+    // Rows after the new one moved down, and the next one is now spread against it
+    for (size_t later = row; later < table.instrument_name.size(); ++later)
+    {
+        m_rows[table.instrument_name[later]] = {table_index->second, static_cast<uint32_t>(later)};
+    }
+    if (row + 1 < table.instrument_name.size())
+    {
+        UpdateSpread(table, row + 1);
+    }
+    ref = {table_index->second, static_cast<uint32_t>(row)};
+    return true;
+}
+
+void BasisMonitor::InsertRow(CurrencyTable& table, const size_t row, const std::string& instrument_name,
+                             const int64_t expiry)
+{
+    const auto at = [row](auto& column) { return column.begin() + static_cast<std::ptrdiff_t>(row); };
+    table.instrument_name.insert(at(table.instrument_name), instrument_name);
+    table.expiry.insert(at(table.expiry), expiry);
+    table.mid.insert(at(table.mid), NOT_AVAILABLE);
+    table.index.insert(at(table.index), NOT_AVAILABLE);
+    table.basis.insert(at(table.basis), NOT_AVAILABLE);
+    table.annualized_basis.insert(at(table.annualized_basis), NOT_AVAILABLE);
+    table.funding.insert(at(table.funding), NOT_AVAILABLE);
+    table.calendar_spread.insert(at(table.calendar_spread), NOT_AVAILABLE);
+    table.forward_rate.insert(at(table.forward_rate), NOT_AVAILABLE);
+    table.carry.insert(at(table.carry), NOT_AVAILABLE);
+    table.timestamp.insert(at(table.timestamp), 0);
+    table.thresholds.emplace(at(table.thresholds));
+}
+
+double BasisMonitor::GetMetric(const CurrencyTable& table, const size_t row, const BasisMetric metric) noexcept
+{
+    switch (metric)
+    {
+        case BasisMetric::BASIS:
+            return table.basis[row];
+        case BasisMetric::ANNUALIZED_BASIS:
+            return table.annualized_basis[row];
+        case BasisMetric::FUNDING:
+            return table.funding[row];
+        case BasisMetric::CALENDAR_SPREAD:
+            return table.calendar_spread[row];
+        case BasisMetric::FORWARD_RATE:
+            return table.forward_rate[row];
+        case BasisMetric::CARRY:
+            return table.carry[row];
+        default:
+            return NOT_AVAILABLE;
+    }
+}
+
+// Against the previous row; from the perpetual, the forward runs from this tick to expiry
+void BasisMonitor::UpdateSpread(CurrencyTable& table, const size_t row) noexcept
+{
+    if (row == 0)
+    {
+        return;
+    }
+    const size_t previous = row - 1;
+    table.calendar_spread[row] = table.mid[row] - table.mid[previous];
+
+    const int64_t start = table.expiry[previous] == 0 ? table.timestamp[row] : table.expiry[previous];
+    const int64_t span = table.expiry[row] - start;
+    table.forward_rate[row] = span > 0 && table.mid[previous] > 0.0
+                                  ? (table.mid[row] / table.mid[previous] - 1.0) * YEAR_MS / static_cast<double>(span)
+                                  : NOT_AVAILABLE;
+}
+
+void BasisMonitor::UpdateCarry(CurrencyTable& table, const size_t row) noexcept
+{
+    const double funding = table.has_perpetual ? table.funding[0] : NOT_AVAILABLE;
+    table.carry[row] = table.annualized_basis[row] - funding;
+}
+
+void BasisMonitor::CheckThresholds(CurrencyTable& table, const size_t row, const uint32_t metrics)
+{
+    for (Threshold& threshold : table.thresholds[row])
+    {
+        if ((metrics & Bit(threshold.metric)) == 0)
+        {
+            continue;
+        }
+        const double value = GetMetric(table, row, threshold.metric);
+        if (std::isnan(value))
+        {
+            continue;
+        }
+        const int8_t side = value >= threshold.level ? 1 : -1;
+        if (threshold.side != 0 && side != threshold.side)
+        {
+            const BasisEvent event{table.instrument_name[row], threshold.metric, threshold.level, value, side > 0,
+                                   table.timestamp[row]};
+            for (const auto& handler : m_handlers)
+            {
+                handler(event);
+            }
+        }
+        threshold.side = side;
+    }
+}
+
+bool BasisMonitor::AddThreshold(const std::string& instrument_name, const BasisMetric metric, const double level)
+{
+    RowRef ref;
+    if (!FindOrAddRow(instrument_name, ref))
+    {
+        return false;
+    }
+    CurrencyTable& table = m_tables[ref.table];
+    Threshold& threshold = table.thresholds[ref.row].emplace_back(Threshold{metric, level});
+
+    // Start from the side the metric is on now, so only later moves are reported
+    const double value = GetMetric(table, ref.row, metric);
+    threshold.side = std::isnan(value) ? 0 : value >= level ? 1 : -1;
+    return true;
+}
+
+void BasisMonitor::OnTicker(const Ticker& ticker)
+{
+    RowRef ref;
+    if (!FindOrAddRow(ticker.instrument_name, ref))
+    {
+        return;
+    }
+    CurrencyTable& table = m_tables[ref.table];
+    const size_t row = ref.row;
+
+    const bool has_quote = ticker.best_bid_price > 0.0 && ticker.best_ask_price > 0.0;
+    const double mid = has_quote ? (ticker.best_bid_price + ticker.best_ask_price) / 2.0 : ticker.mark_price;
+    const double index = ticker.index_price > 0.0 ? ticker.index_price : NOT_AVAILABLE;
+    table.mid[row] = mid;
+    table.index[row] = index;
+    table.timestamp[row] = ticker.timestamp;
+    table.basis[row] = (mid - index) / index;
+
+    if (table.expiry[row] == 0)
+    {
+        // Funding moves carry on every future; those rows are only touched when it changes
+        const double funding = ticker.funding_8h * 3.0 * 365.0;
+        if (funding != table.funding[row])
+        {
+            table.funding[row] = funding;
+            for (size_t future = row + 1; future < table.instrument_name.size(); ++future)
+            {
+                UpdateCarry(table, future);
+                CheckThresholds(table, future, Bit(BasisMetric::CARRY));
+            }
+        }
+    }
+    else
+    {
+        const int64_t remaining = table.expiry[row] - ticker.timestamp;
+        table.annualized_basis[row] =
+            remaining > 0 ? table.basis[row] * YEAR_MS / static_cast<double>(remaining) : NOT_AVAILABLE;
+        UpdateCarry(table, row);
+    }
+    UpdateSpread(table, row);
+    CheckThresholds(table, row, ALL_METRICS);
+
+    if (row + 1 < table.instrument_name.size())
+    {
+        UpdateSpread(table, row + 1);
+        CheckThresholds(table, row + 1, Bit(BasisMetric::CALENDAR_SPREAD) | Bit(BasisMetric::FORWARD_RATE));
+    }
+}
+
+bool BasisMonitor::GetTermStructure(const std::string& currency, TermStructure& view) const
+{
+    const auto table_index = m_currency_index.find(currency);
+    if (table_index == m_currency_index.end())
+    {
+        view = TermStructure{};
+        return false;
+    }
+    const CurrencyTable& table = m_tables[table_index->second];
+    view.instrument_name = table.instrument_name.data();
+    view.expiry = table.expiry.data();
+    view.mid = table.mid.data();
+    view.index = table.index.data();
+    view.basis = table.basis.data();
+    view.annualized_basis = table.annualized_basis.data();
+    view.funding = table.funding.data();
+    view.calendar_spread = table.calendar_spread.data();
+    view.forward_rate = table.forward_rate.data();
+    view.carry = table.carry.data();
+    view.size = table.instrument_name.size();
+    return true;
+}
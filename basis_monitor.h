@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "exchange_types.h"
+
+enum class BasisMetric : uint8_t
+{
+    BASIS,             // (mid - index) / index
+    ANNUALIZED_BASIS,  // Basis scaled to a year by the time left to expiry; futures only
+    FUNDING,           // 8h funding rate annualized; the perpetual only
+    CALENDAR_SPREAD,   // Mid minus the previous row's mid
+    FORWARD_RATE,      // Annualized rate implied between the previous row and this one
+    CARRY              // Annualized basis less perpetual funding; futures only
+};
+
+// A metric moving across a threshold level in either direction
+struct BasisEvent
+{
+    std::string_view instrument_name;
+    BasisMetric metric;
+    double level;
+    double value;
+    bool is_above;  // Side of the level the metric is now on
+    int64_t timestamp;
+};
+
+using BasisEventHandler = std::function<void(const BasisEvent& event)>;
+
+// Column views of one currency's term structure: the perpetual first if it has been seen, then dated
+// futures by expiry. Metrics that need a leg or a rate that has not ticked yet are NaN. The
+// pointers index straight into the monitor's storage and stay valid until a new instrument of the
+// currency is seen.
+struct TermStructure
+{
+    const std::string* instrument_name{nullptr};
+    const int64_t* expiry{nullptr};  // ms since epoch, 0 for the perpetual
+    const double* mid{nullptr};
+    const double* index{nullptr};
+    const double* basis{nullptr};
+    const double* annualized_basis{nullptr};
+    const double* funding{nullptr};
+    const double* calendar_spread{nullptr};
+    const double* forward_rate{nullptr};
+    const double* carry{nullptr};
+    size_t size{0};
+};
+
+// Basis, calendar spreads and funding-adjusted carry across the perpetual and every dated future
+// of each currency, fed from the ticker channel of each instrument.
+//
+// Each currency is a struct-of-arrays table with one row per instrument, sorted by expiry. Each
+// row's basis uses the index price delivered with its own ticker, so the pair is synchronous. A
+// tick therefore recomputes only its own row and the calendar spread of the row after it; a
+// change in perpetual funding also refreshes carry down the table. Thresholds are checked only on
+// the values that changed, and crossings go to the event handlers, which must not add thresholds.
+// Options, spot and unknown instruments are ignored. Single-threaded.
+class BasisMonitor
+{
+  public:
+    static constexpr int64_t YEAR_MS = 365LL * 24 * 60 * 60 * 1000;
+    static constexpr int64_t EXPIRY_HOUR_UTC = 8;  // Deribit futures expire at 08:00 UTC
+
+  private:
+    struct Threshold
+    {
+        BasisMetric metric;
+        double level;
+        int8_t side{0};  // -1 below, 1 above, 0 until the metric has a value
+    };
+
+    struct CurrencyTable
+    {
+        std::vector<std::string> instrument_name;
+        std::vector<int64_t> expiry;
+        std::vector<double> mid;
+        std::vector<double> index;
+        std::vector<double> basis;
+        std::vector<double> annualized_basis;
+        std::vector<double> funding;
+        std::vector<double> calendar_spread;
+        std::vector<double> forward_rate;
+        std::vector<double> carry;
+        std::vector<int64_t> timestamp;
+        std::vector<std::vector<Threshold>> thresholds;  // Usually empty; scanned in full
+        bool has_perpetual{false};
+    };
+
+    struct RowRef
+    {
+        uint32_t table;
+        uint32_t row;
+    };
+
+    std::unordered_map<std::string, uint32_t> m_currency_index;
+    std::vector<CurrencyTable> m_tables;
+    std::unordered_map<std::string, RowRef> m_rows;
+    std::vector<BasisEventHandler> m_handlers;
+
+    bool FindOrAddRow(const std::string& instrument_name, RowRef& ref);
+    static void InsertRow(CurrencyTable& table, size_t row, const std::string& instrument_name, int64_t expiry);
+    static double GetMetric(const CurrencyTable& table, size_t row, BasisMetric metric) noexcept;
+    static void UpdateSpread(CurrencyTable& table, size_t row) noexcept;
+    static void UpdateCarry(CurrencyTable& table, size_t row) noexcept;
+    void CheckThresholds(CurrencyTable& table, size_t row, uint32_t metrics);
+
+  public:
+    // Expiry of a dated future such as "BTC-27DEC24" in ms since epoch, 0 for a perpetual, -1 for
+    // anything else
+    static int64_t ParseExpiry(std::string_view instrument_name) noexcept;
+
+    void AddEventHandler(BasisEventHandler handler);
+
+    // Adds the instrument's row if it has not ticked yet. False for instruments the monitor ignores.
+    bool AddThreshold(const std::string& instrument_name, BasisMetric metric, double level);
+
+    void OnTicker(const Ticker& ticker);
+
+    // Currency is the instrument prefix, e.g. "BTC" or "ETH_USDC". False if nothing has ticked.
+    bool GetTermStructure(const std::string& currency, TermStructure& view) const;
+};
@@ -0,0 +1,625 @@
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "basis_monitor.h"
+#include "book_codec.h"
+#include "kill_switch.h"
+#include "order_entry_socket.h"
+#include "order_manager.h"
+#include "response_decoder.h"
+#include "utility_manager.h"
+#include "web_socket_client.h"
+
+// Hot-path microbenchmarks. Every case reports ns/op (Google Benchmark's time column) and
+// allocs/op, counted by the global operator new replacement below. Payloads are the checked-in
+// captures under fixtures/, loaded relative to the working directory; run from benchmarks/.
+
+static std::atomic<uint64_t> g_allocation_count{0};
+
+void* operator new(const std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size != 0 ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Snapshots the allocation count when a case starts its timed loop
+class AllocationCounter
+{
+  private:
+    uint64_t m_start;
+
+  public:
+    AllocationCounter() : m_start(g_allocation_count.load(std::memory_order_relaxed))
+    {
+    }
+
+    void Report(benchmark::State& state) const
+    {
+        const uint64_t count = g_allocation_count.load(std::memory_order_relaxed) - m_start;
+        const auto allocations = static_cast<double>(count);
+        state.counters["allocs/op"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    }
+};
+
+// Reaches the private members of DrogonWebSocket; befriended in web_socket_client.h
+class WebSocketClientBenchmark
+{
+  public:
+    static std::string GetFormattedTimestamp()
+    {
+        return DrogonWebSocket::GetFormattedTimestamp();
+    }
+
+    static void HandleMessage(DrogonWebSocket& client, std::string&& message)
+    {
+        client.HandleMessage(std::move(message), nullptr, drogon::WebSocketMessageType::Text);
+    }
+};
+
+// Reaches the private members of OrderEntrySocket; befriended in order_entry_socket.h
+class OrderEntrySocketBenchmark
+{
+  public:
+    // Stands in for a sent request, so the reply can be matched without a connection
+    static void AddPending(OrderEntrySocket& socket, const uint64_t id, OrderCallback callback)
+    {
+        socket.m_pending.push_back({id, std::move(callback), nullptr, nullptr, nullptr});
+    }
+
+    static void HandleMessage(OrderEntrySocket& socket, const std::string& message)
+    {
+        socket.HandleMessage(message);
+    }
+};
+
+static std::string LoadFixture(const std::string& name)
+{
+    std::ifstream file("fixtures/" + name, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Missing fixture fixtures/" << name << "; run from the benchmarks directory\n";
+        std::exit(1);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static void BM_FormatPlaceOrderPath(benchmark::State& state)
+{
+    const OrderParams params{"ETH-PERPETUAL", 2, 2320, "market0000234", static_cast<OrderType>(state.range(0))};
+    const std::string side = "buy";
+    char buffer[2048];
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        int written = OrderManager::FormatPlaceOrderPath(buffer, sizeof(buffer), params, side);
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_FormatPlaceOrderPath)
+    ->ArgName("type")
+    ->Arg(static_cast<int>(OrderType::LIMIT))
+    ->Arg(static_cast<int>(OrderType::MARKET));
+
+static void BM_FormatModifyOrderPath(benchmark::State& state)
+{
+    const std::string order_id = "ETH-14308636889";
+    char buffer[2048];
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        int written = OrderManager::FormatModifyOrderPath(buffer, sizeof(buffer), order_id, 4.0, 2200.0);
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_FormatModifyOrderPath);
+
+static void BM_GetOrderTypeString(benchmark::State& state)
+{
+    uint32_t index = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        std::string type = OrderManager::GetOrderTypeString(static_cast<OrderType>(index++ & 3));
+        benchmark::DoNotOptimize(type);
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_GetOrderTypeString);
+
+static void BM_IsParseJsonGood(benchmark::State& state, const char* fixture)
+{
+    const std::string payload = LoadFixture(fixture);
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        Json::Value json_data;
+        bool parsed = UtilityManager::IsParseJsonGood(payload, json_data);
+        benchmark::DoNotOptimize(parsed);
+    }
+    allocations.Report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK_CAPTURE(BM_IsParseJsonGood, order, "order_response.json");
+BENCHMARK_CAPTURE(BM_IsParseJsonGood, positions, "positions_response.json");
+BENCHMARK_CAPTURE(BM_IsParseJsonGood, order_book, "order_book_response.json");
+
+// The same payloads through the single-pass decoders the order manager now uses, for comparison.
+// Outputs are reused across iterations the way the WebSocket client reuses its buffers.
+static void BM_DecodeOrder(benchmark::State& state)
+{
+    const std::string payload = LoadFixture("order_response.json");
+    Order order;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool decoded = ResponseDecoder::DecodeOrder(payload, order);
+        benchmark::DoNotOptimize(decoded);
+    }
+    allocations.Report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK(BM_DecodeOrder);
+
+static void BM_DecodePositions(benchmark::State& state)
+{
+    const std::string payload = LoadFixture("positions_response.json");
+    std::vector<Position> positions;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool decoded = ResponseDecoder::DecodePositions(payload, positions);
+        benchmark::DoNotOptimize(decoded);
+    }
+    allocations.Report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK(BM_DecodePositions);
+
+static void BM_DecodeOrderBook(benchmark::State& state)
+{
+    const std::string payload = LoadFixture("order_book_response.json");
+    OrderBookSnapshot book;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool decoded = ResponseDecoder::DecodeOrderBook(payload, book);
+        benchmark::DoNotOptimize(decoded);
+    }
+    allocations.Report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK(BM_DecodeOrderBook);
+
+static void BM_GetFormattedTimestamp(benchmark::State& state)
+{
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        std::string timestamp = WebSocketClientBenchmark::GetFormattedTimestamp();
+        benchmark::DoNotOptimize(timestamp);
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_GetFormattedTimestamp);
+
+static void BM_DisplayFormattedTimestamp(benchmark::State& state)
+{
+    int64_t timestamp_ms = 1729874400123;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        std::string timestamp = UtilityManager::DisplayFormattedTimestamp(timestamp_ms);
+        benchmark::DoNotOptimize(timestamp);
+        timestamp_ms += 1000;
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_DisplayFormattedTimestamp);
+
+// Dispatch of one notification frame to registered handlers. The channel line HandleMessage
+// prints goes to a null stream, so this measures decoding and formatting, not console I/O.
+static void BM_HandleMessage(benchmark::State& state, const char* fixture)
+{
+    const std::string payload = LoadFixture(fixture);
+    DrogonWebSocket client;
+    uint64_t tickers = 0;
+    uint64_t trades = 0;
+    client.AddTickerHandler([&tickers](const Ticker&) { ++tickers; });
+    client.AddTradeHandler([&trades](const Trade&) { ++trades; });
+
+    std::ostream null_stream(nullptr);
+    std::streambuf* const cout_buffer = std::cout.rdbuf(null_stream.rdbuf());
+
+    // HandleMessage only reads the frame, so the copy below reuses the string's capacity
+    std::string message;
+    message.reserve(payload.size());
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        message.assign(payload);
+        WebSocketClientBenchmark::HandleMessage(client, std::move(message));
+    }
+    allocations.Report(state);
+
+    std::cout.rdbuf(cout_buffer);
+    std::cout.clear();  // Writes to the null stream set badbit
+    if (tickers + trades == 0)
+    {
+        state.SkipWithError("No handler was invoked; fixture did not decode");
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK_CAPTURE(BM_HandleMessage, ticker, "ticker_notification.json");
+BENCHMARK_CAPTURE(BM_HandleMessage, trades, "trades_notification.json");
+
+// One order-entry round trip on the WebSocket path after the send: record the request in flight,
+// then match the reply by id, decode it and run the callback. Steady state should not allocate.
+static void BM_OrderEntryReply(benchmark::State& state)
+{
+    const std::string payload = LoadFixture("order_response.json");
+    uint64_t reply_id = 0;
+    if (!ResponseDecoder::DecodeResponseId(payload, reply_id))
+    {
+        state.SkipWithError("Fixture carries no JSON-RPC id");
+        return;
+    }
+    // The credentials are never sent; the session is not connected
+    OrderEntrySocket socket("fixtures/credentials.txt", "fixtures/credentials.txt");
+    uint64_t filled = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        OrderEntrySocketBenchmark::AddPending(socket, reply_id,
+                                              [&filled](const bool success, const Order&) { filled += success; });
+        OrderEntrySocketBenchmark::HandleMessage(socket, payload);
+    }
+    allocations.Report(state);
+
+    if (filled != static_cast<uint64_t>(state.iterations()))
+    {
+        state.SkipWithError("Replies did not decode");
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+BENCHMARK(BM_OrderEntryReply);
+
+// A stream of book updates grown from the captured book: each changes a few amounts, and every
+// fourth also takes out one level and adds another at the far end, like the book moving
+static std::vector<OrderBookSnapshot> MakeBookUpdates(const size_t count)
+{
+    OrderBookSnapshot book;
+    if (!ResponseDecoder::DecodeOrderBook(LoadFixture("order_book_response.json"), book) || book.bids.empty() ||
+        book.asks.empty())
+    {
+        std::cerr << "fixtures/order_book_response.json did not decode\n";
+        std::exit(1);
+    }
+    std::vector<OrderBookSnapshot> updates;
+    updates.reserve(count);
+    uint32_t state = 12345;
+    const auto next = [&state]()
+    {
+        state = state * 1103515245 + 12345;
+        return state >> 8;
+    };
+    for (size_t update = 0; update < count; ++update)
+    {
+        book.change_id += 1;
+        book.timestamp += 1 + next() % 100;
+        for (int change = 0; change < 3; ++change)
+        {
+            std::vector<PriceLevel>& levels = next() % 2 == 0 ? book.bids : book.asks;
+            levels[next() % levels.size()].amount = static_cast<double>(1 + next() % 500);
+        }
+        if (update % 4 == 3)
+        {
+            const bool bids = next() % 2 == 0;
+            std::vector<PriceLevel>& levels = bids ? book.bids : book.asks;
+            levels.erase(levels.begin() + static_cast<std::ptrdiff_t>(next() % levels.size()));
+            // Whole ticks of 0.05, rounded so the price is the double its decimal parses to
+            const double far = levels.back().price + (bids ? -0.05 : 0.05);
+            levels.push_back({std::round(far * 20.0) / 20.0, static_cast<double>(1 + next() % 500)});
+        }
+        book.best_bid_price = book.bids.front().price;
+        book.best_bid_amount = book.bids.front().amount;
+        book.best_ask_price = book.asks.front().price;
+        book.best_ask_amount = book.asks.front().amount;
+        updates.push_back(book);
+    }
+    return updates;
+}
+
+static constexpr size_t BOOK_UPDATES = 1024;
+
+static void ReportFrameBytes(benchmark::State& state, const uint64_t bytes)
+{
+    const auto total = static_cast<double>(bytes);
+    state.counters["bytes/update"] = benchmark::Counter(total, benchmark::Counter::kAvgIterations);
+}
+
+// Book distribution: the whole book as JSON on every update, against the binary stream of
+// deltas with a snapshot every 100 frames, uncompressed and compressed. The 0.05 tick and unit
+// amount step are ETH-PERPETUAL's.
+static void BM_EncodeBookJson(benchmark::State& state)
+{
+    const std::vector<OrderBookSnapshot> updates = MakeBookUpdates(BOOK_UPDATES);
+    std::string frame;
+    uint64_t bytes = 0;
+    size_t update = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        BookEncoder::EncodeJson(updates[update++ % BOOK_UPDATES], frame);
+        bytes += frame.size();
+        benchmark::DoNotOptimize(frame.data());
+    }
+    allocations.Report(state);
+    ReportFrameBytes(state, bytes);
+}
+BENCHMARK(BM_EncodeBookJson);
+
+static void BM_EncodeBook(benchmark::State& state)
+{
+    const std::vector<OrderBookSnapshot> updates = MakeBookUpdates(BOOK_UPDATES);
+    BookEncoder encoder(0.05, 1.0);
+    encoder.SetCompression(state.range(0) != 0, 64);
+    std::string frame;
+    uint64_t bytes = 0;
+    size_t update = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool encoded = encoder.Encode(updates[update++ % BOOK_UPDATES], frame);
+        benchmark::DoNotOptimize(encoded);
+        bytes += frame.size();
+    }
+    allocations.Report(state);
+    ReportFrameBytes(state, bytes);
+}
+BENCHMARK(BM_EncodeBook)->ArgName("compress")->Arg(0)->Arg(1);
+
+// What a client joining mid-stream is sent first
+static void BM_EncodeBookSnapshot(benchmark::State& state)
+{
+    const std::vector<OrderBookSnapshot> updates = MakeBookUpdates(1);
+    BookEncoder encoder(0.05, 1.0);
+    encoder.SetCompression(state.range(0) != 0, 64);
+    std::string frame;
+    encoder.Encode(updates.front(), frame);
+    uint64_t bytes = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool encoded = encoder.EncodeSnapshot(frame);
+        benchmark::DoNotOptimize(encoded);
+        bytes += frame.size();
+    }
+    allocations.Report(state);
+    ReportFrameBytes(state, bytes);
+}
+BENCHMARK(BM_EncodeBookSnapshot)->ArgName("compress")->Arg(0)->Arg(1);
+
+// The client side: the JSON frames through the single-pass decoder, against applying the binary
+// stream. Both write out the whole book every update.
+static void BM_DecodeBookJson(benchmark::State& state)
+{
+    const std::vector<OrderBookSnapshot> updates = MakeBookUpdates(BOOK_UPDATES);
+    std::vector<std::string> frames(BOOK_UPDATES);
+    for (size_t update = 0; update < BOOK_UPDATES; ++update)
+    {
+        BookEncoder::EncodeJson(updates[update], frames[update]);
+    }
+    OrderBookSnapshot book;
+    size_t update = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool decoded = ResponseDecoder::DecodeOrderBook(frames[update++ % BOOK_UPDATES], book);
+        benchmark::DoNotOptimize(decoded);
+    }
+    allocations.Report(state);
+}
+BENCHMARK(BM_DecodeBookJson);
+
+static void BM_DecodeBook(benchmark::State& state)
+{
+    // The stream opens with a snapshot, so the decoder starts over cleanly each time it wraps
+    const std::vector<OrderBookSnapshot> updates = MakeBookUpdates(BOOK_UPDATES);
+    BookEncoder encoder(0.05, 1.0);
+    encoder.SetCompression(state.range(0) != 0, 64);
+    std::vector<std::string> frames(BOOK_UPDATES);
+    for (size_t update = 0; update < BOOK_UPDATES; ++update)
+    {
+        encoder.Encode(updates[update], frames[update]);
+    }
+    BookDecoder decoder;
+    OrderBookSnapshot book;
+    uint64_t decoded_count = 0;
+    size_t update = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool decoded = decoder.Decode(frames[update++ % BOOK_UPDATES], book);
+        benchmark::DoNotOptimize(decoded);
+        decoded_count += decoded;
+    }
+    allocations.Report(state);
+
+    if (decoded_count != static_cast<uint64_t>(state.iterations()))
+    {
+        state.SkipWithError("Frames did not decode");
+    }
+}
+BENCHMARK(BM_DecodeBook)->ArgName("compress")->Arg(0)->Arg(1);
+
+// One ticker through the basis monitor. A perpetual and eight dated futures of one currency tick in
+// turn; every future's mid swings across its index each other round, crossing a basis threshold,
+// and the perpetual's funding changes every round, refreshing carry on all eight futures.
+static void BM_BasisMonitorTick(benchmark::State& state)
+{
+    static constexpr const char* INSTRUMENTS[] = {"BTC-PERPETUAL", "BTC-27DEC24", "BTC-31JAN25",
+                                                  "BTC-28FEB25",   "BTC-28MAR25", "BTC-27JUN25",
+                                                  "BTC-26SEP25",   "BTC-26DEC25", "BTC-27MAR26"};
+    static constexpr size_t ROUNDS = 16;
+    static constexpr int64_t START_MS = 1730419200000;  // 1 November 2024, before the first expiry
+
+    std::vector<Ticker> tickers;
+    tickers.reserve(ROUNDS * std::size(INSTRUMENTS));
+    for (size_t round = 0; round < ROUNDS; ++round)
+    {
+        for (size_t instrument = 0; instrument < std::size(INSTRUMENTS); ++instrument)
+        {
+            Ticker ticker;
+            ticker.instrument_name = INSTRUMENTS[instrument];
+            ticker.index_price = 70000.0;
+            const double swing = (round / 2) % 2 == 0 ? 25.0 : -25.0;
+            const double mid = ticker.index_price + static_cast<double>(instrument) * 150.0 + swing;
+            ticker.best_bid_price = mid - 2.5;
+            ticker.best_ask_price = mid + 2.5;
+            ticker.mark_price = mid;
+            ticker.funding_8h = instrument == 0 ? 0.0001 * static_cast<double>(round % 4) : 0.0;
+            ticker.timestamp = START_MS + static_cast<int64_t>(round) * 100;
+            tickers.push_back(std::move(ticker));
+        }
+    }
+
+    BasisMonitor monitor;
+    uint64_t events = 0;
+    monitor.AddEventHandler([&events](const BasisEvent&) { ++events; });
+    for (size_t instrument = 1; instrument < std::size(INSTRUMENTS); ++instrument)
+    {
+        const double level = static_cast<double>(instrument) * 150.0 / 70000.0;
+        monitor.AddThreshold(INSTRUMENTS[instrument], BasisMetric::BASIS, level);
+    }
+    for (const Ticker& ticker : tickers)
+    {
+        monitor.OnTicker(ticker);
+    }
+    if (events == 0)
+    {
+        state.SkipWithError("No threshold was crossed");
+        return;
+    }
+    events = 0;
+    size_t tick = 0;
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        monitor.OnTicker(tickers[tick++ % tickers.size()]);
+    }
+    allocations.Report(state);
+    state.counters["events/op"] = benchmark::Counter(static_cast<double>(events), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_BasisMonitorTick);
+
+// One kill switch trigger across WebSocket sessions, from the trigger to the report. With no exchange
+// connection every session refuses its cancel_all and the sweep finishes at once, so this is the
+// switch's own cost per trigger, short of the single write per session a live sweep adds. The log
+// lines go to null streams; dispatch_us is the report's trigger to last send.
+static void BM_KillSwitchTrigger(benchmark::State& state)
+{
+    const auto session_count = static_cast<size_t>(state.range(0));
+    std::vector<std::unique_ptr<OrderEntrySocket>> sockets;
+    KillSwitch kill_switch;
+    for (size_t session = 0; session < session_count; ++session)
+    {
+        // The credentials are never sent; the sessions are not connected
+        sockets.push_back(std::make_unique<OrderEntrySocket>("fixtures/credentials.txt", "fixtures/credentials.txt"));
+        kill_switch.AddSocketSession("ws-" + std::to_string(session), *sockets.back());
+    }
+    uint64_t reports = 0;
+    double dispatch_us = 0.0;
+    kill_switch.SetReportHandler(
+        [&reports, &dispatch_us](const KillReport& report)
+        {
+            ++reports;
+            dispatch_us += report.dispatch_us;
+        });
+
+    std::ostream null_stream(nullptr);
+    std::streambuf* const cout_buffer = std::cout.rdbuf(null_stream.rdbuf());
+    std::streambuf* const cerr_buffer = std::cerr.rdbuf(null_stream.rdbuf());
+
+    const AllocationCounter allocations;
+    for (auto _ : state)
+    {
+        bool triggered = kill_switch.Trigger(KillReason::MANUAL);
+        benchmark::DoNotOptimize(triggered);
+    }
+    allocations.Report(state);
+
+    std::cout.rdbuf(cout_buffer);
+    std::cerr.rdbuf(cerr_buffer);
+    std::cout.clear();
+    std::cerr.clear();
+    if (reports != static_cast<uint64_t>(state.iterations()))
+    {
+        state.SkipWithError("Sweeps did not finish");
+    }
+    state.counters["dispatch_us"] = benchmark::Counter(dispatch_us, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_KillSwitchTrigger)->ArgName("sessions")->Arg(1)->Arg(4)->Arg(16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,649 @@
+#include "book_codec.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+constexpr uint8_t TYPE_MASK = 0x0F;
+constexpr uint8_t COMPRESSED_FLAG = 0x80;
+constexpr uint8_t PRICES_CHANGED_FLAG = 0x01;
+constexpr uint64_t MAX_FRAME_BYTES = 16 * 1024 * 1024;  // Sanity bound on a compressed frame's raw length
+
+// Sort keys: best first on both sides, so bids compare on their negated price
+constexpr int64_t BID_SIDE = -1;
+constexpr int64_t ASK_SIDE = 1;
+
+void AppendVarint(std::string& frame, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        frame.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    frame.push_back(static_cast<char>(value));
+}
+
+// Small differences of either sign take one or two bytes
+void AppendZigzag(std::string& frame, const int64_t value)
+{
+    AppendVarint(frame, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+// Host byte order; every platform this builds for is little-endian
+void AppendDouble(std::string& frame, const double value)
+{
+    char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    frame.append(bytes, sizeof(bytes));
+}
+
+class FrameReader
+{
+  private:
+    const uint8_t* m_position;
+    const uint8_t* m_end;
+
+  public:
+    explicit FrameReader(const std::string_view data)
+        : m_position(reinterpret_cast<const uint8_t*>(data.data())), m_end(m_position + data.size())
+    {
+    }
+
+    bool ReadVarint(uint64_t& value) noexcept
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && m_position != m_end; shift += 7)
+        {
+            const uint8_t byte = *m_position++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ReadZigzag(int64_t& value) noexcept
+    {
+        uint64_t encoded = 0;
+        if (!ReadVarint(encoded))
+        {
+            return false;
+        }
+        value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+        return true;
+    }
+
+    bool ReadDouble(double& value) noexcept
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(double))
+        {
+            return false;
+        }
+        std::memcpy(&value, m_position, sizeof(double));
+        m_position += sizeof(double);
+        return true;
+    }
+
+    bool ReadByte(uint8_t& value) noexcept
+    {
+        if (m_position == m_end)
+        {
+            return false;
+        }
+        value = *m_position++;
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        uint64_t length = 0;
+        if (!ReadVarint(length) || length > static_cast<uint64_t>(m_end - m_position))
+        {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_position), length);
+        m_position += length;
+        return true;
+    }
+
+    std::string_view GetRemaining() const noexcept
+    {
+        return std::string_view(reinterpret_cast<const char*>(m_position), static_cast<size_t>(m_end - m_position));
+    }
+
+    bool IsAtEnd() const noexcept
+    {
+        return m_position == m_end;
+    }
+};
+
+// 1 / step when that is a whole number, so 0.05 ticks convert by dividing by 20: the quotient is
+// then the double nearest the exchange's decimal, the same one its JSON parses to
+double GetInverse(const double step) noexcept
+{
+    const double inverse = std::round(1.0 / step);
+    return inverse >= 1.0 && std::fabs(inverse * step - 1.0) < 1e-12 ? inverse : 0.0;
+}
+
+double FromFixed(const int64_t units, const double step) noexcept
+{
+    const double inverse = GetInverse(step);
+    return inverse != 0.0 ? static_cast<double>(units) / inverse : static_cast<double>(units) * step;
+}
+
+bool IsWhole(const double value, const double step, int64_t& units) noexcept
+{
+    const double scaled = value / step;
+    if (!std::isfinite(scaled) || std::fabs(scaled) > 9.0e15)
+    {
+        return false;
+    }
+    units = std::llround(scaled);
+    return std::fabs(scaled - static_cast<double>(units)) < 1e-6;
+}
+
+bool ReadLevels(FrameReader& reader, std::vector<BookLevel>& levels, int64_t previous)
+{
+    uint64_t count = 0;
+    if (!reader.ReadVarint(count) || count > reader.GetRemaining().size() / 2)
+    {
+        return false;  // Every level takes at least two bytes
+    }
+    levels.resize(count);
+    for (BookLevel& level : levels)
+    {
+        int64_t difference = 0;
+        if (!reader.ReadZigzag(difference) || !reader.ReadVarint(level.amount))
+        {
+            return false;
+        }
+        level.price = previous + difference;
+        previous = level.price;
+    }
+    return true;
+}
+
+// Merges one side's changes into its levels; both run best first
+bool ApplyChanges(FrameReader& reader, std::vector<BookLevel>& levels, std::vector<BookLevel>& merged,
+                  const int64_t side)
+{
+    uint64_t count = 0;
+    if (!reader.ReadVarint(count) || count > reader.GetRemaining().size() / 2)
+    {
+        return false;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+    merged.clear();
+    int64_t previous = levels.empty() ? 0 : levels.front().price;
+    size_t next = 0;
+    for (uint64_t index = 0; index < count; ++index)
+    {
+        BookLevel change;
+        int64_t difference = 0;
+        if (!reader.ReadZigzag(difference) || !reader.ReadVarint(change.amount))
+        {
+            return false;
+        }
+        change.price = previous + difference;
+        if (index != 0 && side * change.price <= side * previous)
+        {
+            return false;  // Changes must go best first, once per price
+        }
+        previous = change.price;
+
+        while (next < levels.size() && side * levels[next].price < side * change.price)
+        {
+            merged.push_back(levels[next++]);
+        }
+        if (next < levels.size() && levels[next].price == change.price)
+        {
+            ++next;
+        }
+        if (change.amount != 0)
+        {
+            merged.push_back(change);
+        }
+    }
+    merged.insert(merged.end(), levels.begin() + static_cast<std::ptrdiff_t>(next), levels.end());
+    levels.swap(merged);
+    return true;
+}
+
+void FillLevels(const std::vector<BookLevel>& levels, const double price_tick, const double amount_step,
+                std::vector<PriceLevel>& out)
+{
+    out.resize(levels.size());
+    for (size_t index = 0; index < levels.size(); ++index)
+    {
+        out[index].price = FromFixed(levels[index].price, price_tick);
+        out[index].amount = FromFixed(static_cast<int64_t>(levels[index].amount), amount_step);
+    }
+}
+
+// Shortest text that parses back to the same double, several times faster than snprintf's %g
+template <typename T>
+void AppendNumber(std::string& frame, const T value)
+{
+    char buffer[32];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    frame.append(buffer, result.ptr);
+}
+
+void AppendJsonLevels(std::string& frame, const std::vector<PriceLevel>& levels)
+{
+    frame.push_back('[');
+    for (size_t index = 0; index < levels.size(); ++index)
+    {
+        frame.append(index == 0 ? "[" : ",[");
+        AppendNumber(frame, levels[index].price);
+        frame.push_back(',');
+        AppendNumber(frame, levels[index].amount);
+        frame.push_back(']');
+    }
+    frame.push_back(']');
+}
+}  // namespace
+
+BookEncoder::BookEncoder(const double price_tick, const double amount_step)
+    : m_price_tick(price_tick), m_amount_step(amount_step)
+{
+}
+
+BookEncoder::~BookEncoder()
+{
+    if (m_deflate_ready)
+    {
+        deflateEnd(&m_deflate);
+    }
+}
+
+void BookEncoder::SetSnapshotInterval(const uint32_t frames) noexcept
+{
+    m_snapshot_interval = frames;
+}
+
+void BookEncoder::SetCompression(const bool enabled, const size_t min_bytes)
+{
+    m_compress_min_bytes = min_bytes;
+    m_compress = enabled;
+    if (enabled && !m_deflate_ready)
+    {
+        // Raw deflate, no zlib header or checksum: frames are short and the transport checks them.
+        // Fastest level, since a frame is compressed on the publishing path.
+        m_deflate_ready = deflateInit2(&m_deflate, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        if (!m_deflate_ready)
+        {
+            std::cerr << "Book encoder: deflateInit2 failed; frames go uncompressed\n";
+            m_compress = false;
+        }
+    }
+}
+
+bool BookEncoder::ToFixed(const std::vector<PriceLevel>& levels, std::vector<BookLevel>& fixed) const
+{
+    fixed.clear();
+    for (const PriceLevel& level : levels)
+    {
+        int64_t price = 0;
+        int64_t amount = 0;
+        if (!IsWhole(level.price, m_price_tick, price) || !IsWhole(level.amount, m_amount_step, amount) ||
+            amount < 0)
+        {
+            std::cerr << "Book encoder: level " << level.price << " x " << level.amount
+                      << " is off the price or amount grid\n";
+            return false;
+        }
+        if (amount != 0)
+        {
+            fixed.push_back({price, static_cast<uint64_t>(amount)});
+        }
+    }
+    return true;
+}
+
+bool BookEncoder::Encode(const OrderBookSnapshot& book, std::string& frame)
+{
+    frame.clear();
+    if (!ToFixed(book.bids, m_next_bids) || !ToFixed(book.asks, m_next_asks))
+    {
+        return false;
+    }
+
+    ++m_sequence;
+    const bool snapshot = !m_has_book || book.instrument_name != m_instrument_name ||
+                          (m_snapshot_interval != 0 && m_frames_since_snapshot >= m_snapshot_interval);
+    if (!snapshot)
+    {
+        WriteDelta(frame, book);
+        ++m_frames_since_snapshot;
+    }
+
+    m_has_book = true;
+    m_instrument_name = book.instrument_name;
+    m_change_id = book.change_id;
+    m_timestamp = book.timestamp;
+    m_mark_price = book.mark_price;
+    m_index_price = book.index_price;
+    m_bids.swap(m_next_bids);
+    m_asks.swap(m_next_asks);
+
+    if (snapshot)
+    {
+        WriteSnapshot(frame);
+        m_frames_since_snapshot = 0;
+    }
+    Finish(frame);
+    return true;
+}
+
+bool BookEncoder::EncodeSnapshot(std::string& frame)
+{
+    frame.clear();
+    if (!m_has_book)
+    {
+        return false;
+    }
+    WriteSnapshot(frame);
+    Finish(frame);
+    return true;
+}
+
+void BookEncoder::WriteSnapshot(std::string& frame) const
+{
+    frame.push_back(static_cast<char>(BookFrameType::SNAPSHOT));
+    AppendVarint(frame, m_sequence);
+    AppendZigzag(frame, m_change_id);
+    AppendZigzag(frame, m_timestamp);
+    AppendVarint(frame, m_instrument_name.size());
+    frame.append(m_instrument_name);
+    AppendDouble(frame, m_price_tick);
+    AppendDouble(frame, m_amount_step);
+    AppendDouble(frame, m_mark_price);
+    AppendDouble(frame, m_index_price);
+
+    int64_t previous = 0;
+    for (const std::vector<BookLevel>* levels : {&m_bids, &m_asks})
+    {
+        AppendVarint(frame, levels->size());
+        for (const BookLevel& level : *levels)
+        {
+            AppendZigzag(frame, level.price - previous);
+            AppendVarint(frame, level.amount);
+            previous = level.price;
+        }
+        // The first ask follows the best bid, not the worst
+        previous = m_bids.empty() ? 0 : m_bids.front().price;
+    }
+}
+
+void BookEncoder::WriteDelta(std::string& frame, const OrderBookSnapshot& book)
+{
+    frame.push_back(static_cast<char>(BookFrameType::DELTA));
+    AppendVarint(frame, m_sequence);
+    AppendZigzag(frame, book.change_id - m_change_id);
+    AppendZigzag(frame, book.timestamp - m_timestamp);
+    if (book.mark_price != m_mark_price || book.index_price != m_index_price)
+    {
+        frame.push_back(static_cast<char>(PRICES_CHANGED_FLAG));
+        AppendDouble(frame, book.mark_price);
+        AppendDouble(frame, book.index_price);
+    }
+    else
+    {
+        frame.push_back('\0');
+    }
+    WriteChanges(frame, m_bids, m_next_bids, BID_SIDE);
+    WriteChanges(frame, m_asks, m_next_asks, ASK_SIDE);
+}
+
+void BookEncoder::WriteChanges(std::string& frame, const std::vector<BookLevel>& before,
+                               const std::vector<BookLevel>& after, const int64_t side)
+{
+    // Walk both sides best first; a price on only one side, or with a new amount, is a change
+    m_changes.clear();
+    size_t old_index = 0;
+    size_t new_index = 0;
+    while (old_index < before.size() || new_index < after.size())
+    {
+        if (new_index == after.size() ||
+            (old_index < before.size() && side * before[old_index].price < side * after[new_index].price))
+        {
+            m_changes.push_back({before[old_index++].price, 0});
+        }
+        else if (old_index == before.size() || side * after[new_index].price < side * before[old_index].price)
+        {
+            m_changes.push_back(after[new_index++]);
+        }
+        else
+        {
+            if (before[old_index].amount != after[new_index].amount)
+            {
+                m_changes.push_back(after[new_index]);
+            }
+            ++old_index;
+            ++new_index;
+        }
+    }
+
+    AppendVarint(frame, m_changes.size());
+    int64_t previous = before.empty() ? 0 : before.front().price;
+    for (const BookLevel& change : m_changes)
+    {
+        AppendZigzag(frame, change.price - previous);
+        AppendVarint(frame, change.amount);
+        previous = change.price;
+    }
+}
+
+void BookEncoder::Finish(std::string& frame)
+{
+    ++m_stats.frames;
+    m_stats.snapshots += frame[0] == static_cast<char>(BookFrameType::SNAPSHOT) ? 1 : 0;
+
+    const size_t body_size = frame.size() - 1;
+    if (m_compress && body_size >= m_compress_min_bytes && deflateReset(&m_deflate) == Z_OK)
+    {
+        m_scratch.resize(deflateBound(&m_deflate, static_cast<uLong>(body_size)));
+        m_deflate.next_in = reinterpret_cast<Bytef*>(&frame[1]);
+        m_deflate.avail_in = static_cast<uInt>(body_size);
+        m_deflate.next_out = reinterpret_cast<Bytef*>(&m_scratch[0]);
+        m_deflate.avail_out = static_cast<uInt>(m_scratch.size());
+        // Kept only if it saves more than the raw length costs to send
+        if (deflate(&m_deflate, Z_FINISH) == Z_STREAM_END && m_deflate.total_out + 4 < body_size)
+        {
+            frame.resize(1);
+            frame[0] = static_cast<char>(frame[0] | COMPRESSED_FLAG);
+            AppendVarint(frame, body_size);
+            frame.append(m_scratch, 0, m_deflate.total_out);
+            ++m_stats.compressed;
+        }
+    }
+    m_stats.bytes += frame.size();
+}
+
+void BookEncoder::EncodeJson(const OrderBookSnapshot& book, std::string& frame)
+{
+    // Instrument names are plain ASCII with no characters that need escaping
+    frame.assign("{\"jsonrpc\":\"2.0\",\"result\":{\"instrument_name\":\"");
+    frame.append(book.instrument_name);
+    frame.append("\",\"timestamp\":");
+    AppendNumber(frame, book.timestamp);
+    frame.append(",\"change_id\":");
+    AppendNumber(frame, book.change_id);
+    frame.append(",\"mark_price\":");
+    AppendNumber(frame, book.mark_price);
+    frame.append(",\"index_price\":");
+    AppendNumber(frame, book.index_price);
+    frame.append(",\"best_bid_price\":");
+    AppendNumber(frame, book.best_bid_price);
+    frame.append(",\"best_bid_amount\":");
+    AppendNumber(frame, book.best_bid_amount);
+    frame.append(",\"best_ask_price\":");
+    AppendNumber(frame, book.best_ask_price);
+    frame.append(",\"best_ask_amount\":");
+    AppendNumber(frame, book.best_ask_amount);
+    frame.append(",\"bids\":");
+    AppendJsonLevels(frame, book.bids);
+    frame.append(",\"asks\":");
+    AppendJsonLevels(frame, book.asks);
+    frame.append("}}");
+}
+
+uint64_t BookEncoder::GetSequence() const noexcept
+{
+    return m_sequence;
+}
+
+const BookCodecStats& BookEncoder::GetStats() const noexcept
+{
+    return m_stats;
+}
+
+BookDecoder::~BookDecoder()
+{
+    if (m_inflate_ready)
+    {
+        inflateEnd(&m_inflate);
+    }
+}
+
+bool BookDecoder::Decode(const std::string_view frame, OrderBookSnapshot& book)
+{
+    if (frame.empty())
+    {
+        return false;
+    }
+    const auto header = static_cast<uint8_t>(frame[0]);
+    const auto type = static_cast<BookFrameType>(header & TYPE_MASK);
+    if (type != BookFrameType::SNAPSHOT && type != BookFrameType::DELTA)
+    {
+        return false;
+    }
+    std::string_view body = frame.substr(1);
+
+    if ((header & COMPRESSED_FLAG) != 0)
+    {
+        if (!m_inflate_ready)
+        {
+            m_inflate_ready = inflateInit2(&m_inflate, -15) == Z_OK;
+        }
+        FrameReader reader(body);
+        uint64_t raw_size = 0;
+        if (!m_inflate_ready || !reader.ReadVarint(raw_size) || raw_size > MAX_FRAME_BYTES ||
+            inflateReset(&m_inflate) != Z_OK)
+        {
+            return false;
+        }
+        body = reader.GetRemaining();
+
+        m_scratch.resize(raw_size);
+        m_inflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+        m_inflate.avail_in = static_cast<uInt>(body.size());
+        m_inflate.next_out = reinterpret_cast<Bytef*>(&m_scratch[0]);
+        m_inflate.avail_out = static_cast<uInt>(raw_size);
+        if (inflate(&m_inflate, Z_FINISH) != Z_STREAM_END || m_inflate.total_out != raw_size)
+        {
+            return false;
+        }
+        body = m_scratch;
+    }
+
+    if (!DecodeBody(body, type == BookFrameType::SNAPSHOT))
+    {
+        return false;
+    }
+    Fill(book);
+    return true;
+}
+
+bool BookDecoder::DecodeBody(const std::string_view body, const bool snapshot)
+{
+    if (!snapshot && !m_has_book)
+    {
+        return false;  // Waiting for a snapshot
+    }
+    FrameReader reader(body);
+    uint64_t sequence = 0;
+    int64_t change_id = 0;
+    int64_t timestamp = 0;
+    if (!reader.ReadVarint(sequence) || !reader.ReadZigzag(change_id) || !reader.ReadZigzag(timestamp))
+    {
+        return false;
+    }
+    if (!snapshot && sequence != m_sequence + 1)
+    {
+        std::cerr << "Book stream for " << m_instrument_name << ": frame " << sequence << " after " << m_sequence
+                  << "; waiting for a snapshot\n";
+        m_has_book = false;
+        return false;
+    }
+
+    // From here a malformed frame has left the book half applied, so it needs a snapshot too
+    m_has_book = false;
+    if (snapshot)
+    {
+        if (!reader.ReadString(m_instrument_name) || !reader.ReadDouble(m_price_tick) ||
+            !reader.ReadDouble(m_amount_step) || !reader.ReadDouble(m_mark_price) ||
+            !reader.ReadDouble(m_index_price) || !ReadLevels(reader, m_bids, 0) ||
+            !ReadLevels(reader, m_asks, m_bids.empty() ? 0 : m_bids.front().price))
+        {
+            return false;
+        }
+        m_change_id = change_id;
+        m_timestamp = timestamp;
+    }
+    else
+    {
+        uint8_t flags = 0;
+        if (!reader.ReadByte(flags) ||
+            ((flags & PRICES_CHANGED_FLAG) != 0 &&
+             (!reader.ReadDouble(m_mark_price) || !reader.ReadDouble(m_index_price))) ||
+            !ApplyChanges(reader, m_bids, m_merged, BID_SIDE) || !ApplyChanges(reader, m_asks, m_merged, ASK_SIDE))
+        {
+            return false;
+        }
+        m_change_id += change_id;
+        m_timestamp += timestamp;
+    }
+    if (!reader.IsAtEnd())
+    {
+        return false;
+    }
+    m_sequence = sequence;
+    m_has_book = true;
+    return true;
+}
+
+void BookDecoder::Fill(OrderBookSnapshot& book) const
+{
+    book.instrument_name.assign(m_instrument_name);
+    book.mark_price = m_mark_price;
+    book.index_price = m_index_price;
+    book.timestamp = m_timestamp;
+    book.change_id = m_change_id;
+    FillLevels(m_bids, m_price_tick, m_amount_step, book.bids);
+    FillLevels(m_asks, m_price_tick, m_amount_step, book.asks);
+    book.best_bid_price = book.bids.empty() ? 0.0 : book.bids.front().price;
+    book.best_bid_amount = book.bids.empty() ? 0.0 : book.bids.front().amount;
+    book.best_ask_price = book.asks.empty() ? 0.0 : book.asks.front().price;
+    book.best_ask_amount = book.asks.empty() ? 0.0 : book.asks.front().amount;
+}
+
+bool BookDecoder::NeedsSnapshot() const noexcept
+{
+    return !m_has_book;
+}
+
+uint64_t BookDecoder::GetSequence() const noexcept
+{
+    return m_sequence;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include "exchange_types.h"
+
+// First byte of every binary frame: the frame type in the low bits, flags in the high ones
+enum class BookFrameType : uint8_t
+{
+    SNAPSHOT = 1,  // The whole book; a decoder can start from any snapshot
+    DELTA = 2      // Levels changed since the previous frame; amount 0 removes a level
+};
+
+struct BookCodecStats
+{
+    uint64_t frames{0};
+    uint64_t snapshots{0};
+    uint64_t compressed{0};  // Frames sent compressed because it made them smaller
+    uint64_t bytes{0};       // Frame bytes written, after compression
+};
+
+// Level in fixed point: price in ticks, amount in amount steps
+struct BookLevel
+{
+    int64_t price{0};
+    uint64_t amount{0};
+};
+
+// Compact binary stream of one instrument's book for downstream clients, in place of rebroadcasting
+// the exchange's JSON on every update. Prices are fixed point in ticks and amounts in amount steps.
+// A frame is the header byte, then varints:
+//
+//   sequence, change_id and timestamp (zigzag differences from the previous frame in a delta)
+//   SNAPSHOT: instrument name, tick and amount step (raw doubles), mark and index (raw doubles),
+//             then per side a level count and each level
+//   DELTA:    a byte saying whether mark and index follow (raw doubles), then per side a change
+//             count and each change
+//
+// A level is its price as a zigzag difference from the level before it, then its amount. The first
+// bid of a snapshot is relative to zero and the first ask to the best bid; the first change of a
+// delta is relative to that side's best price before the change. Levels go best first.
+//
+// With compression on, a frame at least min_bytes long is deflated after its header byte when that
+// makes it smaller, and flagged in the header; the raw length comes first so the decoder can size
+// its buffer. Compression only pays on snapshots of deep books.
+//
+// Single-threaded. Encode allocates nothing once its buffers have grown to the deepest book.
+class BookEncoder
+{
+  public:
+    static constexpr uint32_t DEFAULT_SNAPSHOT_INTERVAL = 100;
+    static constexpr size_t DEFAULT_COMPRESS_MIN_BYTES = 256;
+
+  private:
+    double m_price_tick;
+    double m_amount_step;
+    uint32_t m_snapshot_interval{DEFAULT_SNAPSHOT_INTERVAL};
+    bool m_compress{false};
+    size_t m_compress_min_bytes{DEFAULT_COMPRESS_MIN_BYTES};
+    z_stream m_deflate{};
+    bool m_deflate_ready{false};
+    std::string m_scratch;
+
+    // The book as of the last frame
+    bool m_has_book{false};
+    uint64_t m_sequence{0};
+    uint32_t m_frames_since_snapshot{0};
+    std::string m_instrument_name;
+    int64_t m_change_id{0};
+    int64_t m_timestamp{0};
+    double m_mark_price{0.0};
+    double m_index_price{0.0};
+    std::vector<BookLevel> m_bids;
+    std::vector<BookLevel> m_asks;
+    std::vector<BookLevel> m_next_bids;
+    std::vector<BookLevel> m_next_asks;
+    std::vector<BookLevel> m_changes;
+
+    BookCodecStats m_stats;
+
+    bool ToFixed(const std::vector<PriceLevel>& levels, std::vector<BookLevel>& fixed) const;
+    void WriteSnapshot(std::string& frame) const;
+    void WriteChanges(std::string& frame, const std::vector<BookLevel>& before,
+                      const std::vector<BookLevel>& after, int64_t side);
+    void WriteDelta(std::string& frame, const OrderBookSnapshot& book);
+    void Finish(std::string& frame);
+
+  public:
+    // Every price must be a whole number of ticks and every amount a whole number of steps, as on
+    // the exchange; Encode refuses a book that is not, rather than round it
+    BookEncoder(double price_tick, double amount_step);
+    ~BookEncoder();
+    BookEncoder(const BookEncoder&) = delete;
+    BookEncoder& operator=(const BookEncoder&) = delete;
+
+    // A snapshot replaces the delta after every interval deltas, so a client that lost a frame
+    // recovers without asking; 0 sends deltas only
+    void SetSnapshotInterval(uint32_t frames) noexcept;
+    void SetCompression(bool enabled, size_t min_bytes = DEFAULT_COMPRESS_MIN_BYTES);
+
+    // Next frame in the stream: a snapshot if one is due, else a delta from the previous book.
+    // Overwrites frame; false, with frame empty, if the book is off the price or amount grid.
+    bool Encode(const OrderBookSnapshot& book, std::string& frame);
+
+    // Snapshot of the last book at the current sequence, for a client joining mid-stream; the
+    // stream's next delta follows on from it. False if nothing has been encoded yet.
+    bool EncodeSnapshot(std::string& frame);
+
+    // The book as a get_order_book style JSON-RPC result, for clients that want text;
+    // ResponseDecoder::DecodeOrderBook reads it back
+    static void EncodeJson(const OrderBookSnapshot& book, std::string& frame);
+
+    uint64_t GetSequence() const noexcept;
+    const BookCodecStats& GetStats() const noexcept;
+};
+
+// Rebuilds the book from an encoder's frames. A delta that does not follow on from the previous
+// frame means frames were lost: it is refused, and so is every delta after it until a snapshot
+// arrives. Decode allocates nothing once its buffers have grown to the deepest book.
+class BookDecoder
+{
+  private:
+    z_stream m_inflate{};
+    bool m_inflate_ready{false};
+    std::string m_scratch;
+
+    bool m_has_book{false};
+    uint64_t m_sequence{0};
+    double m_price_tick{0.0};
+    double m_amount_step{0.0};
+    std::string m_instrument_name;
+    int64_t m_change_id{0};
+    int64_t m_timestamp{0};
+    double m_mark_price{0.0};
+    double m_index_price{0.0};
+    std::vector<BookLevel> m_bids;
+    std::vector<BookLevel> m_asks;
+    std::vector<BookLevel> m_merged;
+
+    bool DecodeBody(std::string_view body, bool snapshot);
+    void Fill(OrderBookSnapshot& book) const;
+
+  public:
+    BookDecoder() = default;
+    ~BookDecoder();
+    BookDecoder(const BookDecoder&) = delete;
+    BookDecoder& operator=(const BookDecoder&) = delete;
+
+    // Applies one frame and writes the whole book out, reusing book's storage. False for a
+    // malformed frame or a sequence gap, leaving book untouched.
+    bool Decode(std::string_view frame, OrderBookSnapshot& book);
+
+    // True until the first snapshot and after a gap
+    bool NeedsSnapshot() const noexcept;
+    uint64_t GetSequence() const noexcept;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Typed views of the Deribit REST payloads. Field names mirror the exchange JSON keys so the
+// descriptor tables in response_decoder.cpp stay a one-to-one mapping.
+
+struct Order
+{
+    std::string order_id;
+    std::string instrument_name;
+    std::string order_type;     // "limit", "market", "stop_limit", "stop_market"
+    std::string order_state;    // "open", "filled", "rejected", "cancelled", "untriggered"
+    std::string direction;      // "buy" or "sell"
+    std::string time_in_force;  // "good_til_cancelled", "fill_or_kill", "immediate_or_cancel"
+    std::string label;
+    double amount{0.0};
+    double filled_amount{0.0};
+    double price{0.0};  // Left at zero for market orders, which report "market_price"
+    double average_price{0.0};
+    int64_t creation_timestamp{0};
+    int64_t last_update_timestamp{0};
+};
+
+struct Position
+{
+    std::string instrument_name;
+    std::string direction;
+    std::string kind;
+    double size{0.0};
+    double mark_price{0.0};
+    double average_price{0.0};
+    double floating_profit_loss{0.0};
+    double total_profit_loss{0.0};
+    double leverage{0.0};
+    double maintenance_margin{0.0};
+    double initial_margin{0.0};
+    double open_orders_margin{0.0};
+    int64_t creation_timestamp{0};
+};
+
+struct PriceLevel
+{
+    double price{0.0};
+    double amount{0.0};
+};
+
+struct OrderBookSnapshot
+{
+    std::string instrument_name;
+    double best_bid_price{0.0};
+    double best_bid_amount{0.0};
+    double best_ask_price{0.0};
+    double best_ask_amount{0.0};
+    double mark_price{0.0};
+    double index_price{0.0};
+    int64_t timestamp{0};
+    int64_t change_id{0};
+    std::vector<PriceLevel> bids;  // Best first
+    std::vector<PriceLevel> asks;  // Best first
+};
+
+// Payload of a ticker.{instrument}.{interval} notification
+struct Ticker
+{
+    std::string instrument_name;
+    double best_bid_price{0.0};
+    double best_bid_amount{0.0};
+    double best_ask_price{0.0};
+    double best_ask_amount{0.0};
+    double last_price{0.0};
+    double mark_price{0.0};
+    double index_price{0.0};
+    double open_interest{0.0};
+    double current_funding{0.0};  // Perpetuals only
+    double funding_8h{0.0};       // Perpetuals only
+    int64_t timestamp{0};
+};
+
+// One element of a trades.{instrument}.{interval} notification
+struct Trade
+{
+    std::string trade_id;
+    std::string instrument_name;
+    std::string direction;  // Taker side
+    double price{0.0};
+    double amount{0.0};
+    double mark_price{0.0};
+    double index_price{0.0};
+    int64_t trade_seq{0};
+    int64_t timestamp{0};
+};
+
+struct AuthResult
+{
+    std::string access_token;
+    std::string refresh_token;
+    std::string token_type;
+    std::string scope;
+    int64_t expires_in{0};
+};
@@ -0,0 +1,569 @@
+#include "execution_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+constexpr double EPSILON = 1e-9;
+
+double RoundToLot(const double amount, const double lot_size)
+{
+    if (lot_size <= 0.0)
+    {
+        return amount;
+    }
+    return std::floor(amount / lot_size + EPSILON) * lot_size;
+}
+
+bool IsTerminalState(const std::string& order_state)
+{
+    return order_state == "filled" || order_state == "cancelled" || order_state == "rejected";
+}
+
+// Child labels are "<prefix>-<slot>-<generation>-<sequence>"; the prefix may itself contain '-'
+bool ParseChildLabel(const std::string& label, uint32_t& slot, uint32_t& generation, uint32_t& sequence)
+{
+    uint32_t* fields[] = {&sequence, &generation, &slot};
+    size_t end = label.size();
+    for (uint32_t* field : fields)
+    {
+        const size_t dash = label.rfind('-', end - 1);
+        if (end == 0 || dash == std::string::npos || dash + 1 >= end)
+        {
+            return false;
+        }
+        char* parse_end = nullptr;
+        const unsigned long value = std::strtoul(label.c_str() + dash + 1, &parse_end, 10);
+        if (parse_end != label.c_str() + end)
+        {
+            return false;
+        }
+        *field = static_cast<uint32_t>(value);
+        end = dash;
+    }
+    return true;
+}
+}  // namespace
+
+ExecutionScheduler::ExecutionScheduler(const OrderManager& order_manager, const size_t capacity)
+    : m_order_manager(order_manager), m_parents(capacity)
+{
+    m_free_slots.reserve(capacity);
+    m_active.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; --slot)
+    {
+        m_free_slots.push_back(static_cast<uint32_t>(slot - 1));
+    }
+}
+
+ExecutionScheduler::~ExecutionScheduler()
+{
+    Stop();
+}
+
+void ExecutionScheduler::SetParentOrderCallback(ParentOrderCallback callback)
+{
+    m_callback = std::move(callback);
+}
+
+void ExecutionScheduler::SetStatusPollInterval(const std::chrono::milliseconds interval) noexcept
+{
+    m_status_poll_interval = interval;
+}
+
+ParentOrderId ExecutionScheduler::MakeId(const uint32_t slot, const uint32_t generation) noexcept
+{
+    return (static_cast<ParentOrderId>(generation) << 32) | slot;
+}
+
+ExecutionScheduler::ParentOrder* ExecutionScheduler::Lookup(const uint32_t slot, const uint32_t generation) noexcept
+{
+    if (slot >= m_parents.size())
+    {
+        return nullptr;
+    }
+    ParentOrder& parent = m_parents[slot];
+    return parent.in_use && parent.generation == generation ? &parent : nullptr;
+}
+
+ExecutionScheduler::MarketState& ExecutionScheduler::GetMarket(const std::string& instrument_name)
+{
+    return m_markets[instrument_name];
+}
+
+ParentOrderId ExecutionScheduler::Submit(const ParentOrderParams& params)
+{
+    // Less than one lot could never be sent as a child
+    if (params.lot_size <= 0.0 || params.total_amount < params.lot_size - EPSILON ||
+        (params.side != "buy" && params.side != "sell"))
+    {
+        std::cerr << "Invalid parent order parameters.\n";
+        return INVALID_PARENT;
+    }
+    if (params.algo == ExecutionAlgo::TWAP && params.slices == 0)
+    {
+        std::cerr << "TWAP parent order needs at least one slice.\n";
+        return INVALID_PARENT;
+    }
+    if (m_free_slots.empty())
+    {
+        std::cerr << "Execution scheduler is at capacity.\n";
+        return INVALID_PARENT;
+    }
+
+    const uint32_t slot = m_free_slots.back();
+    m_free_slots.pop_back();
+
+    ParentOrder& parent = m_parents[slot];
+    parent.params = params;
+    parent.status = ParentOrderStatus::ACTIVE;
+    parent.in_use = true;
+    parent.cancel_requested = false;
+    parent.consecutive_rejects = 0;
+    parent.start_time = std::chrono::steady_clock::now();
+    parent.filled_amount = 0.0;
+    parent.filled_notional = 0.0;
+    parent.market_volume = 0.0;
+    parent.child = ChildOrder{};
+    parent.active_position = static_cast<uint32_t>(m_active.size());
+    m_active.push_back(slot);
+    GetMarket(params.instrument_name).parents.push_back(slot);
+
+    // Evaluate may finish the parent on the spot, which retires this generation of the slot
+    const ParentOrderId id = MakeId(slot, parent.generation);
+    Evaluate(slot, parent.start_time);
+    return id;
+}
+
+bool ExecutionScheduler::Cancel(const ParentOrderId parent_id)
+{
+    const auto slot = static_cast<uint32_t>(parent_id & 0xFFFFFFFFu);
+    ParentOrder* parent = Lookup(slot, static_cast<uint32_t>(parent_id >> 32));
+    if (parent == nullptr)
+    {
+        return false;
+    }
+    parent->cancel_requested = true;
+    Evaluate(slot, std::chrono::steady_clock::now());
+    return true;
+}
+
+size_t ExecutionScheduler::GetActiveCount() const noexcept
+{
+    return m_active.size();
+}
+
+// Amount that should be filled or working by now, before clipping to the display size
+double ExecutionScheduler::TargetCumulative(const ParentOrder& parent,
+                                            const std::chrono::steady_clock::time_point now) const
+{
+    const ParentOrderParams& params = parent.params;
+    switch (params.algo)
+    {
+        case ExecutionAlgo::TWAP:
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - parent.start_time);
+            const auto slice_interval = std::max<int64_t>(1, params.duration.count() / params.slices);
+            const auto due_slices = std::min<int64_t>(params.slices, elapsed.count() / slice_interval + 1);
+            return params.total_amount * static_cast<double>(due_slices) / params.slices;
+        }
+        case ExecutionAlgo::POV:
+            // Market volume includes our own fills, which slightly overstates participation
+            return std::min(params.total_amount, parent.market_volume * params.participation_rate);
+        case ExecutionAlgo::ICEBERG:
+        default:
+            return params.total_amount;
+    }
+}
+
+// Passive peg to our side of the touch, never through the parent's limit
+double ExecutionScheduler::ChildPrice(const ParentOrder& parent) const
+{
+    const ParentOrderParams& params = parent.params;
+    const auto market = m_markets.find(params.instrument_name);
+    const bool is_buy = params.side == "buy";
+
+    double price = 0.0;
+    if (market != m_markets.end())
+    {
+        price = is_buy ? market->second.best_bid : market->second.best_ask;
+    }
+    if (params.limit_price > 0.0 && (price <= 0.0 || (is_buy ? price > params.limit_price : price < params.limit_price)))
+    {
+        price = params.limit_price;
+    }
+    return price;
+}
+
+void ExecutionScheduler::Evaluate(const uint32_t slot, const std::chrono::steady_clock::time_point now)
+{
+    ParentOrder& parent = m_parents[slot];
+    ChildOrder& child = parent.child;
+    const ParentOrderParams& params = parent.params;
+
+    if (parent.cancel_requested || parent.consecutive_rejects >= MAX_CONSECUTIVE_REJECTS)
+    {
+        if (child.state == ChildState::IDLE)
+        {
+            Finalize(slot, parent.cancel_requested ? ParentOrderStatus::CANCELLED : ParentOrderStatus::REJECTED);
+        }
+        else if (child.state == ChildState::WORKING)
+        {
+            PollChildStatus(slot, now);
+            if (!child.hold_until_poll)
+            {
+                CancelChild(slot);
+            }
+        }
+        return;
+    }
+
+    const double remaining = RoundToLot(params.total_amount - parent.filled_amount, params.lot_size);
+    if (remaining < params.lot_size - EPSILON && child.state == ChildState::IDLE)
+    {
+        Finalize(slot, ParentOrderStatus::COMPLETED);
+        return;
+    }
+
+    if (child.state != ChildState::IDLE && child.state != ChildState::WORKING)
+    {
+        return;  // Wait for the in-flight request to be acknowledged
+    }
+
+    const double price = ChildPrice(parent);
+    if (price <= 0.0)
+    {
+        return;  // No book yet and no limit to fall back on
+    }
+
+    const double clip = params.display_amount > 0.0 ? params.display_amount : params.total_amount;
+    const double working = child.state == ChildState::WORKING ? child.amount - child.filled_amount : 0.0;
+    const double target = std::min(TargetCumulative(parent, now), params.total_amount);
+    const double shortfall = RoundToLot(std::min(target - parent.filled_amount, clip) - working, params.lot_size);
+
+    if (child.state == ChildState::IDLE)
+    {
+        if (shortfall >= params.lot_size - EPSILON)
+        {
+            SendChild(slot, shortfall, price);
+        }
+        return;
+    }
+
+    // Working child: follow the touch, or top it up when the schedule has moved ahead
+    PollChildStatus(slot, now);
+    const bool price_moved = std::fabs(price - child.price) > params.reprice_threshold + EPSILON;
+    const bool needs_more = shortfall >= params.lot_size - EPSILON;
+    if ((price_moved || needs_more) && !child.hold_until_poll)
+    {
+        EditChild(slot, child.amount + (needs_more ? shortfall : 0.0), price);
+    }
+}
+
+OrderCallback ExecutionScheduler::MakeChildCallback(const uint32_t slot, const bool is_ack)
+{
+    const uint32_t generation = m_parents[slot].generation;
+    const uint32_t sequence = m_parents[slot].child.sequence;
+    return [this, slot, generation, sequence, is_ack](const bool success, const Order& order)
+    { OnChildResponse(slot, generation, sequence, is_ack, success, order); };
+}
+
+void ExecutionScheduler::SendChild(const uint32_t slot, const double amount, const double price)
+{
+    ParentOrder& parent = m_parents[slot];
+    ChildOrder& child = parent.child;
+
+    const uint32_t sequence = child.sequence + 1;
+    child = ChildOrder{};
+    child.state = ChildState::PENDING_NEW;
+    child.sequence = sequence;
+    child.amount = amount;
+    child.price = price;
+    child.last_status_request = std::chrono::steady_clock::now();
+
+    char label[64];
+    const int written = snprintf(label, sizeof(label), "%s-%u-%u-%u", parent.params.label.c_str(), slot,
+                                 parent.generation, child.sequence);
+    if (written < 0 || written >= static_cast<int>(sizeof(label)))
+    {
+        std::cerr << "Child order label too long for parent: " << parent.params.label << "\n";
+        parent.consecutive_rejects = MAX_CONSECUTIVE_REJECTS;
+        child.state = ChildState::IDLE;
+        return;
+    }
+
+    const OrderParams order_params{parent.params.instrument_name, amount, price, label, OrderType::LIMIT,
+                                   "good_til_cancelled"};
+    if (!m_order_manager.PlaceOrder(order_params, parent.params.side, MakeChildCallback(slot, true)))
+    {
+        child.state = ChildState::IDLE;
+        ++parent.consecutive_rejects;
+    }
+}
+
+void ExecutionScheduler::EditChild(const uint32_t slot, const double amount, const double price)
+{
+    ChildOrder& child = m_parents[slot].child;
+    child.state = ChildState::PENDING_EDIT;
+    if (!m_order_manager.ModifyOrder(child.order_id, amount, price, MakeChildCallback(slot, true)))
+    {
+        OnChildRequestFailed(slot);
+    }
+}
+
+void ExecutionScheduler::CancelChild(const uint32_t slot)
+{
+    ChildOrder& child = m_parents[slot].child;
+    child.state = ChildState::PENDING_CANCEL;
+    if (!m_order_manager.CancelOrder(child.order_id, MakeChildCallback(slot, true)))
+    {
+        OnChildRequestFailed(slot);
+    }
+}
+
+void ExecutionScheduler::RequestChildStatus(const uint32_t slot, const std::chrono::steady_clock::time_point now)
+{
+    ChildOrder& child = m_parents[slot].child;
+    child.last_status_request = now;
+    child.status_pending = m_order_manager.GetOrderState(child.order_id, MakeChildCallback(slot, false));
+}
+
+void ExecutionScheduler::PollChildStatus(const uint32_t slot, const std::chrono::steady_clock::time_point now)
+{
+    const ChildOrder& child = m_parents[slot].child;
+    if (m_status_poll_interval.count() > 0 && !child.status_pending &&
+        now - child.last_status_request >= m_status_poll_interval)
+    {
+        RequestChildStatus(slot, now);
+    }
+}
+
+// A failed edit or cancel usually means the child filled or went away, so ask for its state rather
+// than resend at once; a child the exchange keeps refusing counts toward the reject limit.
+void ExecutionScheduler::OnChildRequestFailed(const uint32_t slot)
+{
+    ParentOrder& parent = m_parents[slot];
+    ChildOrder& child = parent.child;
+    child.state = ChildState::WORKING;
+    child.hold_until_poll = true;
+    ++parent.consecutive_rejects;
+    if (!child.status_pending)
+    {
+        RequestChildStatus(slot, std::chrono::steady_clock::now());
+    }
+}
+
+void ExecutionScheduler::OnChildResponse(const uint32_t slot, const uint32_t generation, const uint32_t sequence,
+                                         const bool is_ack, const bool success, const Order& order)
+{
+    ParentOrder* parent = Lookup(slot, generation);
+    if (parent == nullptr || parent->child.sequence != sequence)
+    {
+        return;  // Response for a child that has since been replaced
+    }
+    ChildOrder& child = parent->child;
+    if (!is_ack)
+    {
+        child.status_pending = false;
+    }
+
+    if (success)
+    {
+        if (is_ack)
+        {
+            parent->consecutive_rejects = 0;
+        }
+        ApplyChildOrder(slot, order, is_ack);
+    }
+    else if (!is_ack)
+    {
+        // Past the reject limit, a child the exchange cannot even report on is taken as gone
+        if (parent->consecutive_rejects >= MAX_CONSECUTIVE_REJECTS && child.state == ChildState::WORKING)
+        {
+            std::cerr << "Giving up on child order " << child.order_id << " after "
+                      << parent->consecutive_rejects << " failed requests\n";
+            child.state = ChildState::IDLE;
+        }
+        else
+        {
+            return;
+        }
+    }
+    else if (child.state == ChildState::PENDING_NEW)
+    {
+        // A failed new order leaves nothing on the book
+        child.state = ChildState::IDLE;
+        ++parent->consecutive_rejects;
+    }
+    else
+    {
+        // Retried on the next Poll, not here, so a persistent reject cannot loop at network speed
+        OnChildRequestFailed(slot);
+        return;
+    }
+    Evaluate(slot, std::chrono::steady_clock::now());
+}
+
+void ExecutionScheduler::ApplyChildOrder(const uint32_t slot, const Order& order, const bool is_ack)
+{
+    ParentOrder& parent = m_parents[slot];
+    ChildOrder& child = parent.child;
+
+    if (!order.order_id.empty())
+    {
+        std::snprintf(child.order_id, ORDER_ID_SIZE, "%s", order.order_id.c_str());
+    }
+
+    // Fills are tracked as deltas against what this child has already reported
+    const double filled_delta = order.filled_amount - child.filled_amount;
+    const double notional = order.filled_amount * order.average_price;
+    if (filled_delta > EPSILON)
+    {
+        parent.filled_amount += filled_delta;
+        parent.filled_notional += notional - child.filled_notional;
+        child.filled_amount = order.filled_amount;
+        child.filled_notional = notional;
+    }
+    if (order.amount > 0.0)
+    {
+        child.amount = order.amount;
+    }
+    if (order.price > 0.0)
+    {
+        child.price = order.price;
+    }
+
+    if (IsTerminalState(order.order_state))
+    {
+        child.state = ChildState::IDLE;
+    }
+    else if (is_ack)
+    {
+        child.state = ChildState::WORKING;
+    }
+
+    if (filled_delta > EPSILON)
+    {
+        Notify(slot);
+    }
+}
+
+void ExecutionScheduler::OnTicker(const Ticker& ticker)
+{
+    const auto market = m_markets.find(ticker.instrument_name);
+    if (market == m_markets.end())
+    {
+        return;
+    }
+    market->second.best_bid = ticker.best_bid_price;
+    market->second.best_ask = ticker.best_ask_price;
+
+    // Walk backwards and re-check bounds: Evaluate may finalize parents and shrink the list
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = market->second.parents.size(); i > 0; --i)
+    {
+        if (i <= market->second.parents.size())
+        {
+            Evaluate(market->second.parents[i - 1], now);
+        }
+    }
+}
+
+void ExecutionScheduler::OnTrade(const Trade& trade)
+{
+    const auto market = m_markets.find(trade.instrument_name);
+    if (market == m_markets.end())
+    {
+        return;
+    }
+    for (const uint32_t slot : market->second.parents)
+    {
+        if (m_parents[slot].params.algo == ExecutionAlgo::POV)
+        {
+            m_parents[slot].market_volume += trade.amount;
+        }
+    }
+}
+
+void ExecutionScheduler::OnOrderUpdate(const Order& order)
+{
+    uint32_t slot;
+    uint32_t generation;
+    uint32_t sequence;
+    if (!ParseChildLabel(order.label, slot, generation, sequence))
+    {
+        return;
+    }
+    ParentOrder* parent = Lookup(slot, generation);
+    if (parent == nullptr || parent->child.sequence != sequence)
+    {
+        return;
+    }
+    ApplyChildOrder(slot, order, false);
+    Evaluate(slot, std::chrono::steady_clock::now());
+}
+
+void ExecutionScheduler::Poll(const std::chrono::steady_clock::time_point now)
+{
+    // Walk backwards so Finalize's swap-remove does not skip entries
+    for (size_t i = m_active.size(); i > 0; --i)
+    {
+        const uint32_t slot = m_active[i - 1];
+        m_parents[slot].child.hold_until_poll = false;
+        Evaluate(slot, now);
+    }
+}
+
+void ExecutionScheduler::Start(trantor::EventLoop* loop, const double interval_seconds)
+{
+    Stop();
+    m_loop = loop;
+    m_timer_id = m_loop->runEvery(interval_seconds, [this]() { Poll(std::chrono::steady_clock::now()); });
+}
+
+void ExecutionScheduler::Stop()
+{
+    if (m_loop != nullptr)
+    {
+        m_loop->invalidateTimer(m_timer_id);
+        m_loop = nullptr;
+    }
+}
+
+void ExecutionScheduler::Notify(const uint32_t slot) const
+{
+    if (!m_callback)
+    {
+        return;
+    }
+    const ParentOrder& parent = m_parents[slot];
+    const ParentOrderUpdate update{MakeId(slot, parent.generation), parent.status, parent.filled_amount,
+                                   parent.filled_amount > 0.0 ? parent.filled_notional / parent.filled_amount : 0.0,
+                                   parent.params.total_amount - parent.filled_amount};
+    m_callback(update);
+}
+
+void ExecutionScheduler::Finalize(const uint32_t slot, const ParentOrderStatus status)
+{
+    ParentOrder& parent = m_parents[slot];
+    parent.status = status;
+    Notify(slot);
+
+    // Swap-remove from the active list
+    const uint32_t position = parent.active_position;
+    m_active[position] = m_active.back();
+    m_parents[m_active[position]].active_position = position;
+    m_active.pop_back();
+
+    auto& market_parents = GetMarket(parent.params.instrument_name).parents;
+    market_parents.erase(std::find(market_parents.begin(), market_parents.end(), slot));
+
+    parent.in_use = false;
+    ++parent.generation;
+    m_free_slots.push_back(slot);
+}
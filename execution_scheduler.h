@@ -0,0 +1,174 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <trantor/net/EventLoop.h>
+
+#include "exchange_types.h"
+#include "order_manager.h"
+
+enum class ExecutionAlgo
+{
+    TWAP,     // Evenly spaced slices over a fixed horizon
+    POV,      // Follow a share of the volume printed on the trades stream
+    ICEBERG   // Show at most display_amount, refill as it fills
+};
+
+enum class ParentOrderStatus
+{
+    ACTIVE,
+    COMPLETED,
+    CANCELLED,
+    REJECTED
+};
+
+struct ParentOrderParams
+{
+    std::string instrument_name;
+    std::string side;   // "buy" or "sell"
+    std::string label;  // Prefix for child order labels
+    ExecutionAlgo algo{ExecutionAlgo::TWAP};
+    double total_amount{0.0};        // At least one lot
+    double limit_price{0.0};         // Worst acceptable child price, 0 for none
+    double lot_size{1.0};            // Child amounts are rounded down to a multiple of this
+    double display_amount{0.0};      // Largest working child; the iceberg clip. 0 for no cap
+    double participation_rate{0.1};  // POV target share of traded volume
+    double reprice_threshold{0.0};   // How far the touch may move before a child is edited
+    std::chrono::milliseconds duration{std::chrono::minutes(5)};  // TWAP horizon
+    uint32_t slices{10};                                          // TWAP slice count
+};
+
+using ParentOrderId = uint64_t;
+
+struct ParentOrderUpdate
+{
+    ParentOrderId parent_id;
+    ParentOrderStatus status;
+    double filled_amount;
+    double average_price;
+    double remaining_amount;
+};
+
+using ParentOrderCallback = std::function<void(const ParentOrderUpdate& update)>;
+
+// Works parent orders by slicing them into one resting child order at a time. Parents live in a
+// pool sized at construction and each embeds its child, so steady-state scheduling allocates
+// nothing per child. Children are correlated through their labels, which encode the parent slot.
+//
+// All methods must be called on the event loop the scheduler is started on; OrderManager and
+// DrogonWebSocket callbacks already run on drogon's main loop.
+class ExecutionScheduler
+{
+  public:
+    static constexpr ParentOrderId INVALID_PARENT = ~ParentOrderId{0};
+
+  private:
+    static constexpr size_t ORDER_ID_SIZE = 48;
+    static constexpr int MAX_CONSECUTIVE_REJECTS = 5;
+
+    enum class ChildState : uint8_t
+    {
+        IDLE,
+        PENDING_NEW,
+        WORKING,
+        PENDING_EDIT,
+        PENDING_CANCEL
+    };
+
+    struct ChildOrder
+    {
+        ChildState state{ChildState::IDLE};
+        bool status_pending{false};
+        bool hold_until_poll{false};  // An edit or cancel failed; no retry before the next Poll
+        char order_id[ORDER_ID_SIZE]{};
+        uint32_t sequence{0};
+        double amount{0.0};
+        double filled_amount{0.0};
+        double filled_notional{0.0};
+        double price{0.0};
+        std::chrono::steady_clock::time_point last_status_request;
+    };
+
+    struct ParentOrder
+    {
+        ParentOrderParams params;
+        ParentOrderStatus status{ParentOrderStatus::ACTIVE};
+        uint32_t generation{0};
+        uint32_t active_position{0};
+        bool in_use{false};
+        bool cancel_requested{false};
+        int consecutive_rejects{0};
+        std::chrono::steady_clock::time_point start_time;
+        double filled_amount{0.0};
+        double filled_notional{0.0};
+        double market_volume{0.0};
+        ChildOrder child;
+    };
+
+    struct MarketState
+    {
+        double best_bid{0.0};
+        double best_ask{0.0};
+        std::vector<uint32_t> parents;
+    };
+
+    const OrderManager& m_order_manager;
+    std::vector<ParentOrder> m_parents;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<uint32_t> m_active;
+    std::unordered_map<std::string, MarketState> m_markets;
+    ParentOrderCallback m_callback;
+    std::chrono::milliseconds m_status_poll_interval{1000};
+    trantor::EventLoop* m_loop{nullptr};
+    trantor::TimerId m_timer_id{0};
+
+    static ParentOrderId MakeId(uint32_t slot, uint32_t generation) noexcept;
+    ParentOrder* Lookup(uint32_t slot, uint32_t generation) noexcept;
+    MarketState& GetMarket(const std::string& instrument_name);
+
+    double TargetCumulative(const ParentOrder& parent, std::chrono::steady_clock::time_point now) const;
+    double ChildPrice(const ParentOrder& parent) const;
+    void Evaluate(uint32_t slot, std::chrono::steady_clock::time_point now);
+
+    void SendChild(uint32_t slot, double amount, double price);
+    void EditChild(uint32_t slot, double amount, double price);
+    void CancelChild(uint32_t slot);
+    void RequestChildStatus(uint32_t slot, std::chrono::steady_clock::time_point now);
+    void PollChildStatus(uint32_t slot, std::chrono::steady_clock::time_point now);
+    void OnChildRequestFailed(uint32_t slot);
+    OrderCallback MakeChildCallback(uint32_t slot, bool is_ack);
+    void OnChildResponse(uint32_t slot, uint32_t generation, uint32_t sequence, bool is_ack, bool success,
+                         const Order& order);
+    void ApplyChildOrder(uint32_t slot, const Order& order, bool is_ack);
+
+    void Notify(uint32_t slot) const;
+    void Finalize(uint32_t slot, ParentOrderStatus status);
+
+  public:
+    ExecutionScheduler(const OrderManager& order_manager, size_t capacity);
+    ~ExecutionScheduler();
+
+    void SetParentOrderCallback(ParentOrderCallback callback);
+
+    // How often working children are polled with private/get_order_state. Set to zero when
+    // OnOrderUpdate is fed from a private order stream instead.
+    void SetStatusPollInterval(std::chrono::milliseconds interval) noexcept;
+
+    ParentOrderId Submit(const ParentOrderParams& params);
+    bool Cancel(ParentOrderId parent_id);
+    size_t GetActiveCount() const noexcept;
+
+    void OnTicker(const Ticker& ticker);
+    void OnTrade(const Trade& trade);
+    void OnOrderUpdate(const Order& order);
+
+    // Drives every active parent; Start() calls it from a repeating timer on the loop
+    void Poll(std::chrono::steady_clock::time_point now);
+    void Start(trantor::EventLoop* loop, double interval_seconds);
+    void Stop();
+};
@@ -0,0 +1,453 @@
+#include "json_scanner.h"
+
+#include <charconv>
+
+namespace
+{
+int HexValue(const char c) noexcept
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool ParseHex4(const char* p, uint32_t& code_point) noexcept
+{
+    code_point = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const int value = HexValue(p[i]);
+        if (value < 0)
+        {
+            return false;
+        }
+        code_point = (code_point << 4) | static_cast<uint32_t>(value);
+    }
+    return true;
+}
+
+void AppendUtf8(std::string& out, const uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+}  // namespace
+
+JsonScanner::JsonScanner(const std::string_view input) noexcept
+    : m_cursor(input.data()), m_end(input.data() + input.size())
+{
+}
+
+bool JsonScanner::IsGood() const noexcept
+{
+    return m_good;
+}
+
+void JsonScanner::SkipWhitespace() noexcept
+{
+    while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\n' || *m_cursor == '\r' || *m_cursor == '\t'))
+    {
+        ++m_cursor;
+    }
+}
+
+bool JsonScanner::Consume(const char expected) noexcept
+{
+    SkipWhitespace();
+    if (m_cursor < m_end && *m_cursor == expected)
+    {
+        ++m_cursor;
+        return true;
+    }
+    return Fail();
+}
+
+bool JsonScanner::Fail() noexcept
+{
+    m_good = false;
+    m_cursor = m_end;
+    return false;
+}
+
+JsonTokenType JsonScanner::PeekType() noexcept
+{
+    SkipWhitespace();
+    if (!m_good || m_cursor >= m_end)
+    {
+        return JsonTokenType::INVALID;
+    }
+    switch (*m_cursor)
+    {
+        case '{':
+            return JsonTokenType::OBJECT;
+        case '[':
+            return JsonTokenType::ARRAY;
+        case '"':
+            return JsonTokenType::STRING;
+        case 't':
+        case 'f':
+            return JsonTokenType::BOOLEAN;
+        case 'n':
+            return JsonTokenType::NIL;
+        default:
+            return (*m_cursor == '-' || (*m_cursor >= '0' && *m_cursor <= '9')) ? JsonTokenType::NUMBER
+                                                                                : JsonTokenType::INVALID;
+    }
+}
+
+// Scans a string token and returns its raw contents, escapes untouched
+bool JsonScanner::ScanString(std::string_view& raw) noexcept
+{
+    if (!Consume('"'))
+    {
+        return false;
+    }
+    const char* start = m_cursor;
+    while (m_cursor < m_end && *m_cursor != '"')
+    {
+        if (*m_cursor == '\\')
+        {
+            ++m_cursor;
+        }
+        ++m_cursor;
+    }
+    if (m_cursor >= m_end)
+    {
+        return Fail();
+    }
+    raw = std::string_view(start, static_cast<size_t>(m_cursor - start));
+    ++m_cursor;
+    return true;
+}
+
+bool JsonScanner::ScanNumber(std::string_view& raw) noexcept
+{
+    SkipWhitespace();
+    const char* start = m_cursor;
+    while (m_cursor < m_end)
+    {
+        const char c = *m_cursor;
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+        {
+            ++m_cursor;
+            continue;
+        }
+        break;
+    }
+    if (m_cursor == start)
+    {
+        return Fail();
+    }
+    raw = std::string_view(start, static_cast<size_t>(m_cursor - start));
+    return true;
+}
+
+bool JsonScanner::ScanLiteral(const std::string_view literal) noexcept
+{
+    SkipWhitespace();
+    if (static_cast<size_t>(m_end - m_cursor) < literal.size() ||
+        std::string_view(m_cursor, literal.size()) != literal)
+    {
+        return Fail();
+    }
+    m_cursor += literal.size();
+    return true;
+}
+
+bool JsonScanner::BeginObject() noexcept
+{
+    return Consume('{');
+}
+
+bool JsonScanner::NextKey(std::string_view& key) noexcept
+{
+    SkipWhitespace();
+    if (!m_good || m_cursor >= m_end)
+    {
+        return Fail();
+    }
+    if (*m_cursor == '}')
+    {
+        ++m_cursor;
+        return false;
+    }
+    if (*m_cursor == ',')
+    {
+        ++m_cursor;
+    }
+    return ScanString(key) && Consume(':');
+}
+
+bool JsonScanner::BeginArray() noexcept
+{
+    return Consume('[');
+}
+
+bool JsonScanner::NextElement() noexcept
+{
+    SkipWhitespace();
+    if (!m_good || m_cursor >= m_end)
+    {
+        return Fail();
+    }
+    if (*m_cursor == ']')
+    {
+        ++m_cursor;
+        return false;
+    }
+    if (*m_cursor == ',')
+    {
+        ++m_cursor;
+    }
+    return true;
+}
+
+// Reads a string value, decoding escapes. Numbers and literals are copied as text and null
+// yields an empty string, matching Json::Value::asString.
+bool JsonScanner::ReadString(std::string& out)
+{
+    out.clear();
+    std::string_view raw;
+    switch (PeekType())
+    {
+        case JsonTokenType::STRING:
+            break;
+        case JsonTokenType::NIL:
+            return ScanLiteral("null");
+        case JsonTokenType::NUMBER:
+            if (!ScanNumber(raw))
+            {
+                return false;
+            }
+            out.assign(raw.data(), raw.size());
+            return true;
+        case JsonTokenType::BOOLEAN:
+            if (!CaptureValue(raw))
+            {
+                return false;
+            }
+            out.assign(raw.data(), raw.size());
+            return true;
+        default:
+            return SkipValue();
+    }
+
+    if (!ScanString(raw))
+    {
+        return false;
+    }
+    if (raw.find('\\') == std::string_view::npos)
+    {
+        out.assign(raw.data(), raw.size());
+        return true;
+    }
+
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        if (raw[i] != '\\')
+        {
+            out.push_back(raw[i]);
+            continue;
+        }
+        if (++i >= raw.size())
+        {
+            return Fail();
+        }
+        switch (raw[i])
+        {
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'u':
+            {
+                uint32_t code_point;
+                if (i + 4 >= raw.size() || !ParseHex4(raw.data() + i + 1, code_point))
+                {
+                    return Fail();
+                }
+                i += 4;
+                // Combine a UTF-16 surrogate pair when the low half follows
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 6 < raw.size() &&
+                    raw[i + 1] == '\\' && raw[i + 2] == 'u')
+                {
+                    uint32_t low;
+                    if (ParseHex4(raw.data() + i + 3, low) && low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                AppendUtf8(out, code_point);
+                break;
+            }
+            default:  // '"', '\\' and '/'
+                out.push_back(raw[i]);
+                break;
+        }
+    }
+    return true;
+}
+
+// Reads a number. Non-numeric values (null, "market_price", ...) are skipped and read as zero.
+bool JsonScanner::ReadDouble(double& out) noexcept
+{
+    out = 0.0;
+    if (PeekType() != JsonTokenType::NUMBER)
+    {
+        return SkipValue();
+    }
+    std::string_view raw;
+    if (!ScanNumber(raw))
+    {
+        return false;
+    }
+    const auto [ptr, ec] = std::from_chars(raw.data(), raw.data() + raw.size(), out);
+    return ec == std::errc() && ptr == raw.data() + raw.size() ? true : Fail();
+}
+
+bool JsonScanner::ReadInt64(int64_t& out) noexcept
+{
+    out = 0;
+    if (PeekType() != JsonTokenType::NUMBER)
+    {
+        return SkipValue();
+    }
+    std::string_view raw;
+    if (!ScanNumber(raw))
+    {
+        return false;
+    }
+    const char* last = raw.data() + raw.size();
+    const auto [ptr, ec] = std::from_chars(raw.data(), last, out);
+    if (ec == std::errc() && ptr == last)
+    {
+        return true;
+    }
+
+    // Fractional or exponent form, e.g. 1.5e3
+    double value = 0.0;
+    const auto [dptr, dec] = std::from_chars(raw.data(), last, value);
+    if (dec != std::errc() || dptr != last)
+    {
+        return Fail();
+    }
+    out = static_cast<int64_t>(value);
+    return true;
+}
+
+bool JsonScanner::ReadBool(bool& out) noexcept
+{
+    out = false;
+    if (PeekType() != JsonTokenType::BOOLEAN)
+    {
+        return SkipValue();
+    }
+    if (*m_cursor == 't')
+    {
+        out = true;
+        return ScanLiteral("true");
+    }
+    return ScanLiteral("false");
+}
+
+bool JsonScanner::SkipValue() noexcept
+{
+    std::string_view raw;
+    switch (PeekType())
+    {
+        case JsonTokenType::STRING:
+            return ScanString(raw);
+        case JsonTokenType::NUMBER:
+            return ScanNumber(raw);
+        case JsonTokenType::BOOLEAN:
+            return ScanLiteral(*m_cursor == 't' ? "true" : "false");
+        case JsonTokenType::NIL:
+            return ScanLiteral("null");
+        case JsonTokenType::OBJECT:
+        case JsonTokenType::ARRAY:
+            break;
+        default:
+            return Fail();
+    }
+
+    // Containers are skipped by bracket depth alone; strings are scanned so brackets inside
+    // them are not counted.
+    int depth = 0;
+    while (m_cursor < m_end)
+    {
+        const char c = *m_cursor;
+        if (c == '"')
+        {
+            if (!ScanString(raw))
+            {
+                return false;
+            }
+            continue;
+        }
+        ++m_cursor;
+        if (c == '{' || c == '[')
+        {
+            ++depth;
+        }
+        else if ((c == '}' || c == ']') && --depth == 0)
+        {
+            return true;
+        }
+    }
+    return Fail();
+}
+
+bool JsonScanner::CaptureValue(std::string_view& raw) noexcept
+{
+    SkipWhitespace();
+    const char* start = m_cursor;
+    if (!SkipValue())
+    {
+        return false;
+    }
+    raw = std::string_view(start, static_cast<size_t>(m_cursor - start));
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class JsonTokenType
+{
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NIL,
+    INVALID
+};
+
+// Forward-only pull scanner over a JSON buffer. Nothing is materialised unless the caller asks
+// for it, so a payload is walked exactly once and unknown members are skipped in place.
+class JsonScanner
+{
+  private:
+    const char* m_cursor;
+    const char* m_end;
+    bool m_good{true};
+
+    void SkipWhitespace() noexcept;
+    bool Consume(char expected) noexcept;
+    bool Fail() noexcept;
+    bool ScanString(std::string_view& raw) noexcept;
+    bool ScanNumber(std::string_view& raw) noexcept;
+    bool ScanLiteral(std::string_view literal) noexcept;
+
+  public:
+    explicit JsonScanner(std::string_view input) noexcept;
+
+    bool IsGood() const noexcept;
+    JsonTokenType PeekType() noexcept;
+
+    // Containers: call BeginObject/BeginArray, then loop on NextKey/NextElement until they
+    // return false, which also consumes the closing bracket.
+    bool BeginObject() noexcept;
+    bool NextKey(std::string_view& key) noexcept;
+    bool BeginArray() noexcept;
+    bool NextElement() noexcept;
+
+    bool ReadString(std::string& out);
+    bool ReadDouble(double& out) noexcept;
+    bool ReadInt64(int64_t& out) noexcept;
+    bool ReadBool(bool& out) noexcept;
+
+    bool SkipValue() noexcept;
+    bool CaptureValue(std::string_view& raw) noexcept;  // Raw text of the next value, skipped
+};
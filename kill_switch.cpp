@@ -0,0 +1,317 @@
+#include "kill_switch.h"
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+
+#include <drogon/drogon.h>
+
+#include "utility_manager.h"
+
+namespace
+{
+// The switch holding SIGINT and SIGTERM, if any
+std::atomic<KillSwitch*> g_signal_target{nullptr};
+}  // namespace
+
+KillSwitch::~KillSwitch()
+{
+    // drogon keeps calling HandleSignal, which falls back to a plain quit without a target
+    KillSwitch* expected = this;
+    g_signal_target.compare_exchange_strong(expected, nullptr);
+    Stop();
+    for (Session& session : m_sessions)
+    {
+        if (session.socket != nullptr)
+        {
+            session.socket->SetDisconnectHandler(nullptr);
+        }
+    }
+}
+
+const char* KillSwitch::GetReasonString(const KillReason reason) noexcept
+{
+    switch (reason)
+    {
+        case KillReason::SIGNAL:
+            return "signal";
+        case KillReason::MANUAL:
+            return "manual";
+        case KillReason::RISK_BREACH:
+            return "risk breach";
+        case KillReason::HEARTBEAT_LOST:
+            return "heartbeat lost";
+        case KillReason::DISCONNECTED:
+            return "disconnected";
+        default:
+            return "unknown";
+    }
+}
+
+double KillSwitch::ElapsedUs(const std::chrono::steady_clock::time_point from,
+                             const std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+void KillSwitch::AddSession(const std::string& name, const OrderManager* http, OrderEntrySocket* socket)
+{
+    Session& session = m_sessions.emplace_back();
+    session.name = name;
+    session.http = http;
+    session.socket = socket;
+    session.report.name = name;
+}
+
+void KillSwitch::AddHttpSession(const std::string& name, const OrderManager& order_manager)
+{
+    AddSession(name, &order_manager, nullptr);
+}
+
+void KillSwitch::AddSocketSession(const std::string& name, OrderEntrySocket& socket)
+{
+    AddSession(name, nullptr, &socket);
+    socket.SetCancelOnDisconnect(true);
+    socket.SetHeartbeatInterval(HEARTBEAT_INTERVAL_SECONDS);
+    socket.SetDisconnectHandler([this]() { Trigger(KillReason::DISCONNECTED); });
+}
+
+void KillSwitch::AddSessions(const SessionManager& session_manager)
+{
+    for (SessionId session = 0; session < session_manager.GetSessionCount(); ++session)
+    {
+        AddHttpSession(session_manager.GetSessionName(session), session_manager.GetOrderManager(session));
+    }
+}
+
+void KillSwitch::SetAckTimeout(const std::chrono::milliseconds timeout) noexcept
+{
+    m_ack_timeout = timeout;
+}
+
+void KillSwitch::SetReportHandler(KillReportHandler handler)
+{
+    m_report_handler = std::move(handler);
+}
+
+void KillSwitch::Start(trantor::EventLoop* loop)
+{
+    Stop();
+    m_loop = loop;
+    m_check_timer_id =
+        m_loop->runEvery(CHECK_INTERVAL_SECONDS, [this]() { CheckHeartbeats(std::chrono::steady_clock::now()); });
+}
+
+void KillSwitch::Stop()
+{
+    if (m_loop == nullptr)
+    {
+        return;
+    }
+    m_loop->invalidateTimer(m_check_timer_id);
+    if (m_deadline_timer_id != 0)
+    {
+        m_loop->invalidateTimer(m_deadline_timer_id);
+        m_deadline_timer_id = 0;
+    }
+    m_loop = nullptr;
+}
+
+// drogon::app().run() installs its own SIGINT and SIGTERM handlers, replacing any set with
+// std::signal, so the switch is registered with drogon instead
+void KillSwitch::InstallSignalHandlers()
+{
+    g_signal_target.store(this);
+    drogon::app().setIntSignalHandler([]() { HandleSignal(SIGINT); });
+    drogon::app().setTermSignalHandler([]() { HandleSignal(SIGTERM); });
+}
+
+// drogon runs this on its main loop, not in signal context. A second signal while the sweep is still
+// waiting on acks quits at once.
+void KillSwitch::HandleSignal(const int signal)
+{
+    const auto triggered = std::chrono::steady_clock::now();
+    KillSwitch* const target = g_signal_target.load();
+    if (target == nullptr || target->m_loop == nullptr || target->m_quit_when_done)
+    {
+        UtilityManager::HandleExitSignal(signal);
+        return;
+    }
+    target->m_loop->runInLoop(
+        [target, signal, triggered]()
+        {
+            // Quits once the report is in; a sweep already under way quits when it finishes
+            target->m_quit_when_done = true;
+            target->Trigger(KillReason::SIGNAL, triggered);
+            std::cout << "Exit signal received: " << signal << ". Shutting down once all orders are cancelled\n";
+        });
+}
+
+bool KillSwitch::Trigger(const KillReason reason)
+{
+    return Trigger(reason, std::chrono::steady_clock::now());
+}
+
+bool KillSwitch::Trigger(const KillReason reason, const std::chrono::steady_clock::time_point triggered)
+{
+    if (m_in_progress)
+    {
+        return false;
+    }
+    m_tripped = true;
+    m_in_progress = true;
+    m_reason = reason;
+    m_triggered = triggered;
+    m_outstanding = 0;
+    const uint32_t sweep = ++m_sweep;
+
+    // Sockets first: their request is already formatted, so each costs one write
+    for (const bool sockets : {true, false})
+    {
+        for (uint32_t index = 0; index < m_sessions.size(); ++index)
+        {
+            Session& session = m_sessions[index];
+            if ((session.socket != nullptr) != sockets)
+            {
+                continue;
+            }
+            KillSessionReport& report = session.report;
+            report.acknowledged = false;
+            report.success = false;
+            report.cancelled = 0;
+            report.ack_us = 0.0;
+
+            // Sixteen bytes, small enough for std::function to hold without allocating
+            CancelAllCallback callback = [this, index, sweep](const bool success, const int64_t cancelled)
+            { OnAck(index, sweep, success, cancelled); };
+            report.sent = sockets ? session.socket->CancelAll(std::move(callback))
+                                  : session.http->CancelAll(std::move(callback));
+            m_outstanding += report.sent ? 1 : 0;
+        }
+    }
+    m_dispatched = std::chrono::steady_clock::now();
+
+    std::cerr << "Kill switch triggered (" << GetReasonString(reason) << "): cancel_all sent on " << m_outstanding
+              << " of " << m_sessions.size() << " sessions\n";
+    if (m_outstanding == 0)
+    {
+        Finish();
+        return true;
+    }
+    if (m_loop != nullptr)
+    {
+        const double timeout_seconds = std::chrono::duration<double>(m_ack_timeout).count();
+        m_deadline_timer_id = m_loop->runAfter(timeout_seconds,
+                                               [this, sweep]()
+                                               {
+                                                   m_deadline_timer_id = 0;
+                                                   if (m_in_progress && m_sweep == sweep)
+                                                   {
+                                                       Finish();
+                                                   }
+                                               });
+    }
+    return true;
+}
+
+void KillSwitch::OnAck(const uint32_t index, const uint32_t sweep, const bool success, const int64_t cancelled)
+{
+    if (!m_in_progress || sweep != m_sweep)
+    {
+        return;  // Answered after the sweep timed out
+    }
+    KillSessionReport& report = m_sessions[index].report;
+    report.acknowledged = true;
+    report.success = success;
+    report.cancelled = cancelled;
+    report.ack_us = ElapsedUs(m_triggered, std::chrono::steady_clock::now());
+    if (--m_outstanding == 0)
+    {
+        Finish();
+    }
+}
+
+void KillSwitch::Finish()
+{
+    const auto finished = std::chrono::steady_clock::now();
+    m_in_progress = false;
+    if (m_loop != nullptr && m_deadline_timer_id != 0)
+    {
+        m_loop->invalidateTimer(m_deadline_timer_id);
+        m_deadline_timer_id = 0;
+    }
+
+    KillReport report;
+    report.reason = m_reason;
+    report.complete = true;
+    report.dispatch_us = ElapsedUs(m_triggered, m_dispatched);
+    report.completion_us = ElapsedUs(m_triggered, finished);
+    report.sessions.reserve(m_sessions.size());
+    for (const Session& session : m_sessions)
+    {
+        const KillSessionReport& session_report = session.report;
+        report.complete = report.complete && session_report.acknowledged && session_report.success;
+        report.cancelled += session_report.cancelled;
+        report.sessions.push_back(session_report);
+    }
+
+    std::cout << "Kill switch (" << GetReasonString(m_reason) << "): " << report.cancelled << " orders cancelled, "
+              << (report.complete ? "every session confirmed" : "NOT every session confirmed") << "; dispatch "
+              << report.dispatch_us << " us, last ack " << report.completion_us << " us\n";
+    for (const KillSessionReport& session_report : report.sessions)
+    {
+        if (!session_report.acknowledged || !session_report.success)
+        {
+            std::cerr << "  " << session_report.name << ": "
+                      << (!session_report.sent           ? "not sent"
+                          : !session_report.acknowledged ? "no ack"
+                                                         : "cancel_all failed")
+                      << "\n";
+        }
+    }
+
+    if (m_report_handler)
+    {
+        m_report_handler(report);
+    }
+    if (m_quit_when_done)
+    {
+        m_quit_when_done = false;
+        drogon::app().quit();
+    }
+}
+
+void KillSwitch::CheckHeartbeats(const std::chrono::steady_clock::time_point now)
+{
+    const auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(HEARTBEAT_INTERVAL_SECONDS * HEARTBEAT_TOLERANCE));
+    for (Session& session : m_sessions)
+    {
+        // A session that is down has already pulled the trigger through its disconnect handler
+        if (session.socket == nullptr || !session.socket->IsReady())
+        {
+            continue;
+        }
+        const bool lost = now - session.socket->GetLastMessageTime() > timeout;
+        const bool newly_lost = lost && !session.heartbeat_lost;
+        session.heartbeat_lost = lost;
+        if (newly_lost)
+        {
+            std::cerr << "Kill switch: no heartbeat on " << session.name << "\n";
+            Trigger(KillReason::HEARTBEAT_LOST);
+        }
+    }
+}
+
+bool KillSwitch::IsTripped() const noexcept
+{
+    return m_tripped;
+}
+
+void KillSwitch::Reset() noexcept
+{
+    if (!m_in_progress)
+    {
+        m_tripped = false;
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <trantor/net/EventLoop.h>
+
+#include "order_entry_socket.h"
+#include "order_manager.h"
+#include "session_manager.h"
+
+enum class KillReason
+{
+    SIGNAL,          // SIGINT or SIGTERM; the application quits once the report is in
+    MANUAL,          // Trigger called by an operator or API
+    RISK_BREACH,     // Trigger called by a risk check
+    HEARTBEAT_LOST,  // A WebSocket session went silent past its heartbeat timeout
+    DISCONNECTED     // A WebSocket session dropped
+};
+
+struct KillSessionReport
+{
+    std::string name;
+    bool sent{false};  // False if the session could not carry the request, e.g. it was down
+    bool acknowledged{false};
+    bool success{false};
+    int64_t cancelled{0};
+    double ack_us{0.0};  // Trigger to this session's ack
+};
+
+struct KillReport
+{
+    KillReason reason{KillReason::MANUAL};
+    bool complete{false};  // Every session sent and acknowledged before the ack timeout
+    int64_t cancelled{0};
+    double dispatch_us{0.0};    // Trigger to the last request handed to its transport: local processing
+    double completion_us{0.0};  // Trigger to the last ack, or to the timeout if one never came
+    std::vector<KillSessionReport> sessions;
+};
+
+using KillReportHandler = std::function<void(const KillReport& report)>;
+
+// Cancels every open order on every session at once. A trigger fires one cancel_all per session,
+// WebSocket sessions first since their request is already formatted, and all of them are on the
+// wire before the first ack can come back. Acks are collected into a KillReport, which goes to the
+// report handler once every session has answered or the ack timeout passes.
+//
+// WebSocket sessions added here also get exchange-side cancel-on-disconnect and heartbeats, so
+// their orders go even if this process cannot act; their heartbeat loss or disconnect pulls the
+// trigger for the other sessions. HTTP sessions have no connection for the exchange to watch and
+// rely on the trigger alone.
+//
+// Tripping does not block order entry; strategies check IsTripped before sending. Triggering again
+// after a report, e.g. for an order that was in flight during the first sweep, sweeps again.
+// Runs on drogon's main loop; call from that loop too.
+class KillSwitch
+{
+  public:
+    static constexpr int HEARTBEAT_INTERVAL_SECONDS = 10;
+    static constexpr double HEARTBEAT_TOLERANCE = 1.5;  // Silence this many intervals long is a loss
+
+  private:
+    static constexpr double CHECK_INTERVAL_SECONDS = 0.1;
+
+    struct Session
+    {
+        std::string name;
+        const OrderManager* http{nullptr};
+        OrderEntrySocket* socket{nullptr};
+        bool heartbeat_lost{false};
+        KillSessionReport report;
+    };
+
+    std::vector<Session> m_sessions;
+    std::chrono::milliseconds m_ack_timeout{2000};
+    KillReportHandler m_report_handler;
+    trantor::EventLoop* m_loop{nullptr};
+    trantor::TimerId m_check_timer_id{0};
+    trantor::TimerId m_deadline_timer_id{0};
+
+    bool m_tripped{false};
+    bool m_in_progress{false};
+    bool m_quit_when_done{false};
+    uint32_t m_sweep{0};  // Tells late acks of an earlier sweep apart
+    size_t m_outstanding{0};
+    KillReason m_reason{KillReason::MANUAL};
+    std::chrono::steady_clock::time_point m_triggered;
+    std::chrono::steady_clock::time_point m_dispatched;
+
+    static void HandleSignal(int signal);
+    static double ElapsedUs(std::chrono::steady_clock::time_point from,
+                            std::chrono::steady_clock::time_point to);
+
+    void AddSession(const std::string& name, const OrderManager* http, OrderEntrySocket* socket);
+    void OnAck(uint32_t index, uint32_t sweep, bool success, int64_t cancelled);
+    void Finish();
+
+  public:
+    KillSwitch() = default;
+    ~KillSwitch();
+    KillSwitch(const KillSwitch&) = delete;
+    KillSwitch& operator=(const KillSwitch&) = delete;
+
+    static const char* GetReasonString(KillReason reason) noexcept;
+
+    // Sessions are not owned and must outlive the switch. Adding a socket takes over its
+    // cancel-on-disconnect, heartbeat interval and disconnect handler.
+    void AddHttpSession(const std::string& name, const OrderManager& order_manager);
+    void AddSocketSession(const std::string& name, OrderEntrySocket& socket);
+    void AddSessions(const SessionManager& session_manager);
+
+    void SetAckTimeout(std::chrono::milliseconds timeout) noexcept;
+    void SetReportHandler(KillReportHandler handler);
+
+    // Heartbeat checks and the ack timeout need the loop; triggers work without it
+    void Start(trantor::EventLoop* loop);
+    void Stop();
+
+    // Routes SIGINT and SIGTERM here instead of straight to quit, through drogon's signal handlers;
+    // call before drogon::app().run(). Needs Start; only one switch can hold the signals at a time.
+    void InstallSignalHandlers();
+
+    // False if a sweep is already in progress
+    bool Trigger(KillReason reason);
+    bool Trigger(KillReason reason, std::chrono::steady_clock::time_point triggered);
+
+    // Pulls the trigger for any WebSocket session silent past its heartbeat timeout
+    void CheckHeartbeats(std::chrono::steady_clock::time_point now);
+
+    bool IsTripped() const noexcept;
+    // Clears the tripped state once the cause is dealt with; ignored during a sweep
+    void Reset() noexcept;
+};
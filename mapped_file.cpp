@@ -0,0 +1,110 @@
+#include "mapped_file.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <cstdint>
+#include <iostream>
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path, const size_t size)
+{
+    Close();
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                    OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Failed to open " << path << ", error " << GetLastError() << "\n";
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER existing;
+    if (!GetFileSizeEx(m_file, &existing))
+    {
+        std::cerr << "Failed to size " << path << ", error " << GetLastError() << "\n";
+        Close();
+        return false;
+    }
+    const uint64_t mapped_size =
+        static_cast<uint64_t>(existing.QuadPart) > size ? static_cast<uint64_t>(existing.QuadPart) : size;
+
+    // Mapping past the end of the file extends it with zeros
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(mapped_size >> 32),
+                                   static_cast<DWORD>(mapped_size & 0xFFFFFFFFu), nullptr);
+    if (m_mapping == nullptr)
+    {
+        std::cerr << "Failed to map " << path << ", error " << GetLastError() << "\n";
+        Close();
+        return false;
+    }
+    m_address = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(mapped_size));
+    if (m_address == nullptr)
+    {
+        std::cerr << "Failed to map view of " << path << ", error " << GetLastError() << "\n";
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(mapped_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_address != nullptr)
+    {
+        UnmapViewOfFile(m_address);
+        m_address = nullptr;
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+    m_size = 0;
+}
+
+// Writes the dirty pages of the range, then the file metadata, to the device
+bool MappedFile::Flush(const size_t offset, const size_t length) const
+{
+    if (m_address == nullptr || length == 0)
+    {
+        return m_address != nullptr;
+    }
+    if (!FlushViewOfFile(static_cast<const char*>(m_address) + offset, length) || !FlushFileBuffers(m_file))
+    {
+        std::cerr << "Failed to flush mapped file, error " << GetLastError() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void* MappedFile::GetAddress() const noexcept
+{
+    return m_address;
+}
+
+size_t MappedFile::GetSize() const noexcept
+{
+    return m_size;
+}
+
+bool MappedFile::Replace(const std::string& source, const std::string& destination)
+{
+    if (!MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        std::cerr << "Failed to replace " << destination << ", error " << GetLastError() << "\n";
+        return false;
+    }
+    return true;
+}
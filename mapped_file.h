@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A file on disk mapped read-write into the address space. Writes land in the OS page cache as
+// soon as they are stored, so they survive the process dying; Flush makes a range durable across
+// a machine crash.
+class MappedFile
+{
+  private:
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+    void* m_address{nullptr};
+    size_t m_size{0};
+
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Creates the file if needed and grows it to at least size bytes; new bytes read as zero.
+    // An existing larger file is mapped whole.
+    bool Open(const std::string& path, size_t size);
+    void Close();
+
+    bool Flush(size_t offset, size_t length) const;
+
+    void* GetAddress() const noexcept;
+    size_t GetSize() const noexcept;
+
+    // Atomically replaces destination with source; neither may be open
+    static bool Replace(const std::string& source, const std::string& destination);
+};
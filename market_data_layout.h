@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the shared-memory market-data region written by MarketDataPublisher and mapped
+// read-only by MarketDataReader:
+//
+//   MarketDataHeader | QuoteSlot[slot_capacity] | TradeEntry[ring_capacity]
+//
+// Quote slots hold the latest top of book per instrument behind a seqlock. The trade ring is a
+// broadcast ring: every reader keeps its own cursor and the writer never waits for anyone. All
+// records are fixed size and free of pointers, so the region means the same thing in every
+// process that maps it.
+
+static constexpr uint32_t MARKET_DATA_MAGIC = 0x474D4442;  // "GMDB"
+static constexpr uint32_t MARKET_DATA_VERSION = 1;
+static constexpr size_t MARKET_DATA_NAME_SIZE = 32;
+static constexpr size_t MARKET_DATA_CACHE_LINE = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Seqlocks in shared memory need lock-free atomics");
+
+struct MarketDataQuote
+{
+    double best_bid_price;
+    double best_bid_amount;
+    double best_ask_price;
+    double best_ask_amount;
+    double last_price;
+    double mark_price;
+    double index_price;
+    int64_t timestamp;  // Exchange time in ms
+    int64_t change_id;  // Book change id of the last order book written, 0 if none
+};
+
+struct MarketDataTrade
+{
+    char instrument_name[MARKET_DATA_NAME_SIZE];
+    char trade_id[MARKET_DATA_NAME_SIZE];
+    char direction;  // 'b' or 's', taker side
+    double price;
+    double amount;
+    double mark_price;
+    double index_price;
+    int64_t trade_seq;
+    int64_t timestamp;
+};
+
+// Sequence is odd while the writer is mid-update and 0 until the slot is first written
+struct alignas(MARKET_DATA_CACHE_LINE) QuoteSlot
+{
+    std::atomic<uint64_t> sequence;
+    char instrument_name[MARKET_DATA_NAME_SIZE];  // Written once, before the slot is published
+    MarketDataQuote quote;
+};
+
+// Entry for trade number n holds sequence 2n + 2 once complete and 2n + 1 while being written
+struct alignas(MARKET_DATA_CACHE_LINE) TradeEntry
+{
+    std::atomic<uint64_t> sequence;
+    MarketDataTrade trade;
+};
+
+struct alignas(MARKET_DATA_CACHE_LINE) MarketDataHeader
+{
+    std::atomic<uint32_t> magic;  // Stored last, so a half-initialised region is never opened
+    uint32_t version;
+    uint32_t slot_capacity;
+    uint32_t ring_capacity;  // Power of two
+    std::atomic<uint32_t> slot_count;
+    alignas(MARKET_DATA_CACHE_LINE) std::atomic<uint64_t> trade_count;  // Trades ever published
+};
+
+inline size_t GetMarketDataRegionSize(const uint32_t slot_capacity, const uint32_t ring_capacity) noexcept
+{
+    return sizeof(MarketDataHeader) + sizeof(QuoteSlot) * slot_capacity + sizeof(TradeEntry) * ring_capacity;
+}
@@ -0,0 +1,164 @@
+#include "market_data_publisher.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+MarketDataPublisher::~MarketDataPublisher()
+{
+    Close();
+}
+
+bool MarketDataPublisher::Open(const std::string& name, const uint32_t slot_capacity,
+                               const uint32_t ring_capacity)
+{
+    Close();
+    if (slot_capacity == 0 || ring_capacity == 0 || (ring_capacity & (ring_capacity - 1)) != 0)
+    {
+        std::cerr << "Market data bus needs at least one slot and a power-of-two trade ring\n";
+        return false;
+    }
+    if (!m_region.Create(name, GetMarketDataRegionSize(slot_capacity, ring_capacity)))
+    {
+        return false;
+    }
+
+    // The mapping starts zeroed; construct the atomics in place before anyone can see the magic
+    auto* base = static_cast<unsigned char*>(m_region.GetAddress());
+    m_header = new (base) MarketDataHeader{};
+    m_slots = reinterpret_cast<QuoteSlot*>(base + sizeof(MarketDataHeader));
+    m_trades = reinterpret_cast<TradeEntry*>(m_slots + slot_capacity);
+    for (uint32_t index = 0; index < slot_capacity; ++index)
+    {
+        new (&m_slots[index]) QuoteSlot{};
+    }
+    for (uint32_t index = 0; index < ring_capacity; ++index)
+    {
+        new (&m_trades[index]) TradeEntry{};
+    }
+
+    m_header->version = MARKET_DATA_VERSION;
+    m_header->slot_capacity = slot_capacity;
+    m_header->ring_capacity = ring_capacity;
+    m_header->magic.store(MARKET_DATA_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void MarketDataPublisher::Close()
+{
+    m_region.Close();
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_trades = nullptr;
+    m_slot_index.clear();
+    m_trade_count = 0;
+}
+
+// Truncates to fit and always leaves a terminating null
+template <size_t N>
+void MarketDataPublisher::CopyName(char (&destination)[N], const std::string& source) noexcept
+{
+    const size_t length = source.size() < N - 1 ? source.size() : N - 1;
+    std::memcpy(destination, source.data(), length);
+    std::memset(destination + length, 0, N - length);
+}
+
+QuoteSlot* MarketDataPublisher::GetSlot(const std::string& instrument_name)
+{
+    const auto existing = m_slot_index.find(instrument_name);
+    if (existing != m_slot_index.end())
+    {
+        return &m_slots[existing->second];
+    }
+
+    const uint32_t index = m_header->slot_count.load(std::memory_order_relaxed);
+    if (index == m_header->slot_capacity)
+    {
+        std::cerr << "Market data bus is out of quote slots, dropping " << instrument_name << "\n";
+        return nullptr;
+    }
+    // Readers only scan names below slot_count, so the name is in place before the count moves
+    CopyName(m_slots[index].instrument_name, instrument_name);
+    m_header->slot_count.store(index + 1, std::memory_order_release);
+    m_slot_index.emplace(instrument_name, index);
+    return &m_slots[index];
+}
+
+void MarketDataPublisher::WriteQuote(QuoteSlot& slot, const MarketDataQuote& quote) noexcept
+{
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.quote, &quote, sizeof(quote));
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool MarketDataPublisher::PublishTicker(const Ticker& ticker)
+{
+    QuoteSlot* slot = m_header != nullptr ? GetSlot(ticker.instrument_name) : nullptr;
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    // Only this process writes the slot, so its current contents can be read without the seqlock
+    MarketDataQuote quote = slot->quote;
+    quote.best_bid_price = ticker.best_bid_price;
+    quote.best_bid_amount = ticker.best_bid_amount;
+    quote.best_ask_price = ticker.best_ask_price;
+    quote.best_ask_amount = ticker.best_ask_amount;
+    quote.last_price = ticker.last_price;
+    quote.mark_price = ticker.mark_price;
+    quote.index_price = ticker.index_price;
+    quote.timestamp = ticker.timestamp;
+    WriteQuote(*slot, quote);
+    return true;
+}
+
+bool MarketDataPublisher::PublishOrderBook(const OrderBookSnapshot& order_book)
+{
+    QuoteSlot* slot = m_header != nullptr ? GetSlot(order_book.instrument_name) : nullptr;
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    MarketDataQuote quote = slot->quote;
+    quote.best_bid_price = order_book.best_bid_price;
+    quote.best_bid_amount = order_book.best_bid_amount;
+    quote.best_ask_price = order_book.best_ask_price;
+    quote.best_ask_amount = order_book.best_ask_amount;
+    quote.mark_price = order_book.mark_price;
+    quote.index_price = order_book.index_price;
+    quote.timestamp = order_book.timestamp;
+    quote.change_id = order_book.change_id;
+    WriteQuote(*slot, quote);
+    return true;
+}
+
+bool MarketDataPublisher::PublishTrade(const Trade& trade)
+{
+    if (m_header == nullptr)
+    {
+        return false;
+    }
+
+    TradeEntry& entry = m_trades[m_trade_count & (m_header->ring_capacity - 1)];
+    entry.sequence.store(2 * m_trade_count + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    MarketDataTrade& record = entry.trade;
+    CopyName(record.instrument_name, trade.instrument_name);
+    CopyName(record.trade_id, trade.trade_id);
+    record.direction = trade.direction == "sell" ? 's' : 'b';
+    record.price = trade.price;
+    record.amount = trade.amount;
+    record.mark_price = trade.mark_price;
+    record.index_price = trade.index_price;
+    record.trade_seq = trade.trade_seq;
+    record.timestamp = trade.timestamp;
+
+    entry.sequence.store(2 * m_trade_count + 2, std::memory_order_release);
+    m_header->trade_count.store(++m_trade_count, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "exchange_types.h"
+#include "market_data_layout.h"
+#include "shared_memory_region.h"
+
+// Feed-handler side of the shared-memory market-data bus. Normalises decoded tickers, order book
+// tops and trades into the fixed layout of market_data_layout.h, so co-located processes read the
+// feed through MarketDataReader instead of each opening a socket and parsing the same JSON.
+//
+// Single writer: publish from one thread, normally the WebSocket client's event loop.
+class MarketDataPublisher
+{
+  private:
+    SharedMemoryRegion m_region;
+    MarketDataHeader* m_header{nullptr};
+    QuoteSlot* m_slots{nullptr};
+    TradeEntry* m_trades{nullptr};
+    std::unordered_map<std::string, uint32_t> m_slot_index;
+    uint64_t m_trade_count{0};
+
+    template <size_t N>
+    static void CopyName(char (&destination)[N], const std::string& source) noexcept;
+
+    QuoteSlot* GetSlot(const std::string& instrument_name);
+    static void WriteQuote(QuoteSlot& slot, const MarketDataQuote& quote) noexcept;
+
+  public:
+    MarketDataPublisher() = default;
+    ~MarketDataPublisher();
+
+    // ring_capacity must be a power of two; it bounds how far a reader may lag before losing trades
+    bool Open(const std::string& name, uint32_t slot_capacity, uint32_t ring_capacity);
+    void Close();
+
+    bool PublishTicker(const Ticker& ticker);
+    bool PublishOrderBook(const OrderBookSnapshot& order_book);
+    bool PublishTrade(const Trade& trade);
+};
@@ -0,0 +1,131 @@
+#include "market_data_reader.h"
+
+#include <cstring>
+#include <iostream>
+
+bool MarketDataReader::Open(const std::string& name)
+{
+    Close();
+    if (!m_region.OpenReadOnly(name))
+    {
+        return false;
+    }
+
+    const auto* base = static_cast<const unsigned char*>(m_region.GetAddress());
+    const auto* header = reinterpret_cast<const MarketDataHeader*>(base);
+    if (m_region.GetSize() < sizeof(MarketDataHeader) ||
+        header->magic.load(std::memory_order_acquire) != MARKET_DATA_MAGIC ||
+        header->version != MARKET_DATA_VERSION ||
+        m_region.GetSize() < GetMarketDataRegionSize(header->slot_capacity, header->ring_capacity))
+    {
+        std::cerr << "Shared memory " << name << " is not a market data bus this reader understands\n";
+        Close();
+        return false;
+    }
+
+    m_header = header;
+    m_slots = reinterpret_cast<const QuoteSlot*>(base + sizeof(MarketDataHeader));
+    m_trades = reinterpret_cast<const TradeEntry*>(m_slots + header->slot_capacity);
+    m_next_trade = header->trade_count.load(std::memory_order_acquire);
+    return true;
+}
+
+void MarketDataReader::Close()
+{
+    m_region.Close();
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_trades = nullptr;
+    m_next_trade = 0;
+    m_dropped_trades = 0;
+}
+
+int32_t MarketDataReader::FindInstrument(const std::string& instrument_name) const
+{
+    if (m_header == nullptr || instrument_name.size() >= MARKET_DATA_NAME_SIZE)
+    {
+        return INVALID_SLOT;
+    }
+    const uint32_t count = m_header->slot_count.load(std::memory_order_acquire);
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        if (std::strncmp(m_slots[index].instrument_name, instrument_name.c_str(), MARKET_DATA_NAME_SIZE) == 0)
+        {
+            return static_cast<int32_t>(index);
+        }
+    }
+    return INVALID_SLOT;
+}
+
+bool MarketDataReader::ReadQuote(const int32_t slot, MarketDataQuote& quote) const
+{
+    if (m_header == nullptr || slot < 0 ||
+        static_cast<uint32_t>(slot) >= m_header->slot_count.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const QuoteSlot& source = m_slots[slot];
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+    {
+        const uint64_t before = source.sequence.load(std::memory_order_acquire);
+        if (before == 0)
+        {
+            return false;
+        }
+        if ((before & 1) != 0)
+        {
+            continue;  // Write in progress
+        }
+        std::memcpy(&quote, &source.quote, sizeof(quote));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source.sequence.load(std::memory_order_relaxed) == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t MarketDataReader::PollTrades(std::vector<MarketDataTrade>& trades)
+{
+    trades.clear();
+    if (m_header == nullptr)
+    {
+        return 0;
+    }
+
+    const uint64_t published = m_header->trade_count.load(std::memory_order_acquire);
+    const uint64_t capacity = m_header->ring_capacity;
+    if (published - m_next_trade > capacity)
+    {
+        // Lapped: the oldest unread trades have already been overwritten
+        m_dropped_trades += published - capacity - m_next_trade;
+        m_next_trade = published - capacity;
+    }
+
+    for (; m_next_trade < published; ++m_next_trade)
+    {
+        const TradeEntry& entry = m_trades[m_next_trade & (capacity - 1)];
+        const uint64_t expected = 2 * m_next_trade + 2;
+        if (entry.sequence.load(std::memory_order_acquire) != expected)
+        {
+            ++m_dropped_trades;  // Overwritten since trade_count was read
+            continue;
+        }
+        trades.emplace_back();
+        std::memcpy(&trades.back(), &entry.trade, sizeof(MarketDataTrade));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) != expected)
+        {
+            trades.pop_back();
+            ++m_dropped_trades;
+        }
+    }
+    return trades.size();
+}
+
+uint64_t MarketDataReader::GetDroppedTrades() const noexcept
+{
+    return m_dropped_trades;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "market_data_layout.h"
+#include "shared_memory_region.h"
+
+// Consumer side of the shared-memory market-data bus. Maps the publisher's region read-only, so
+// any number of local processes can follow the feed without their own connection or JSON parsing.
+// Depends only on market_data_layout.h and shared_memory_region.cpp, not on drogon.
+//
+// Reads never block the publisher: a quote read retries if it overlapped a write, and a reader
+// that falls more than a ring's worth of trades behind skips ahead and counts what it missed.
+class MarketDataReader
+{
+  public:
+    static constexpr int32_t INVALID_SLOT = -1;
+
+  private:
+    static constexpr int MAX_READ_ATTEMPTS = 64;
+
+    SharedMemoryRegion m_region;
+    const MarketDataHeader* m_header{nullptr};
+    const QuoteSlot* m_slots{nullptr};
+    const TradeEntry* m_trades{nullptr};
+    uint64_t m_next_trade{0};
+    uint64_t m_dropped_trades{0};
+
+  public:
+    // Starts the trade cursor at the newest trade, so only trades published afterwards are polled
+    bool Open(const std::string& name);
+    void Close();
+
+    // Slots are assigned on an instrument's first update; resolve once and keep the index
+    int32_t FindInstrument(const std::string& instrument_name) const;
+
+    // False if the slot has never been written or kept changing under the reader
+    bool ReadQuote(int32_t slot, MarketDataQuote& quote) const;
+
+    // Replaces trades with everything published since the last poll, oldest first
+    size_t PollTrades(std::vector<MarketDataTrade>& trades);
+    uint64_t GetDroppedTrades() const noexcept;
+};
@@ -0,0 +1,889 @@
+#include "matching_engine.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+constexpr double EPSILON = 1e-9;
+constexpr const char* ORDER_ID_PREFIX = "SIM-";
+constexpr size_t ORDER_ID_PREFIX_SIZE = 4;
+
+bool ParseTimeInForce(const std::string& time_in_force, uint8_t& value)
+{
+    if (time_in_force.empty() || time_in_force == "good_til_cancelled")
+    {
+        value = 0;
+    }
+    else if (time_in_force == "immediate_or_cancel")
+    {
+        value = 1;
+    }
+    else if (time_in_force == "fill_or_kill")
+    {
+        value = 2;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+const char* TimeInForceString(const uint8_t value)
+{
+    switch (value)
+    {
+        case 1:
+            return "immediate_or_cancel";
+        case 2:
+            return "fill_or_kill";
+        default:
+            return "good_til_cancelled";
+    }
+}
+}  // namespace
+
+MatchingEngine::MatchingEngine(std::string instrument_name, const double tick_size, const size_t capacity)
+    : m_instrument_name(std::move(instrument_name)), m_tick_size(tick_size)
+{
+    m_nodes.reserve(capacity);
+    m_free_nodes.reserve(capacity);
+    m_levels.reserve(1024);
+    m_free_levels.reserve(1024);
+    m_bids.levels.reserve(1024);
+    m_asks.levels.reserve(1024);
+}
+
+void MatchingEngine::SetOrderUpdateHandler(OrderUpdateHandler handler)
+{
+    m_update_handler = std::move(handler);
+}
+
+size_t MatchingEngine::GetOpenOrderCount() const noexcept
+{
+    return m_open_count;
+}
+
+int64_t MatchingEngine::ToTicks(const double price) const noexcept
+{
+    return std::llround(price / m_tick_size);
+}
+
+double MatchingEngine::ToPrice(const int64_t ticks) const noexcept
+{
+    return static_cast<double>(ticks) * m_tick_size;
+}
+
+// Bids improve upwards, asks downwards
+bool MatchingEngine::IsBetter(const BookSide& side, const int64_t lhs, const int64_t rhs) noexcept
+{
+    return side.is_bid ? lhs > rhs : lhs < rhs;
+}
+
+MatchingEngine::BookSide& MatchingEngine::SideOf(const bool is_buy) noexcept
+{
+    return is_buy ? m_bids : m_asks;
+}
+
+MatchingEngine::BookSide& MatchingEngine::OppositeOf(const bool is_buy) noexcept
+{
+    return is_buy ? m_asks : m_bids;
+}
+
+uint32_t MatchingEngine::AcquireNode()
+{
+    uint32_t index;
+    if (!m_free_nodes.empty())
+    {
+        index = m_free_nodes.back();
+        m_free_nodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    OrderNode& node = m_nodes[index];
+    node.filled_amount = 0.0;
+    node.filled_notional = 0.0;
+    node.queue_ahead = 0.0;
+    node.level = NIL;
+    node.prev = NIL;
+    node.next = NIL;
+    return index;
+}
+
+void MatchingEngine::ReleaseNode(const uint32_t index)
+{
+    OrderNode& node = m_nodes[index];
+    node.state = NodeState::FREE;
+    ++node.generation;
+    m_free_nodes.push_back(index);
+}
+
+uint64_t MatchingEngine::MakeId(const uint32_t index) const noexcept
+{
+    return (static_cast<uint64_t>(m_nodes[index].generation) << 32) | index;
+}
+
+// Order ids are "SIM-<generation << 32 | slot>", so lookups need no map
+MatchingEngine::OrderNode* MatchingEngine::Lookup(const std::string& order_id) noexcept
+{
+    if (order_id.compare(0, ORDER_ID_PREFIX_SIZE, ORDER_ID_PREFIX) != 0)
+    {
+        return nullptr;
+    }
+    uint64_t id = 0;
+    const char* end = order_id.data() + order_id.size();
+    const auto [parse_end, error] = std::from_chars(order_id.data() + ORDER_ID_PREFIX_SIZE, end, id);
+    const auto index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    if (error != std::errc() || parse_end != end || index >= m_nodes.size())
+    {
+        return nullptr;
+    }
+    OrderNode& node = m_nodes[index];
+    const bool live = node.state == NodeState::OPEN || node.state == NodeState::UNTRIGGERED;
+    return live && node.generation == static_cast<uint32_t>(id >> 32) ? &node : nullptr;
+}
+
+// Links a new level in front of before, or at the worst end when before is NIL
+uint32_t MatchingEngine::InsertLevel(BookSide& side, const int64_t ticks, const uint32_t before)
+{
+    uint32_t index;
+    if (!m_free_levels.empty())
+    {
+        index = m_free_levels.back();
+        m_free_levels.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_levels.size());
+        m_levels.emplace_back();
+    }
+
+    BookLevel& level = m_levels[index];
+    level.ticks = ticks;
+    level.displayed = 0.0;
+    level.head = NIL;
+    level.tail = NIL;
+    level.next = before;
+    level.prev = before != NIL ? m_levels[before].prev : side.worst;
+    if (level.prev != NIL)
+    {
+        m_levels[level.prev].next = index;
+    }
+    else
+    {
+        side.best = index;
+    }
+    if (before != NIL)
+    {
+        m_levels[before].prev = index;
+    }
+    else
+    {
+        side.worst = index;
+    }
+    side.levels.emplace(ticks, index);
+    return index;
+}
+
+uint32_t MatchingEngine::GetOrCreateLevel(BookSide& side, const int64_t ticks)
+{
+    const auto existing = side.levels.find(ticks);
+    if (existing != side.levels.end())
+    {
+        return existing->second;
+    }
+    // New orders mostly land near the touch, so walk from the best price
+    uint32_t before = side.best;
+    while (before != NIL && !IsBetter(side, ticks, m_levels[before].ticks))
+    {
+        before = m_levels[before].next;
+    }
+    return InsertLevel(side, ticks, before);
+}
+
+void MatchingEngine::ReleaseLevelIfEmpty(BookSide& side, const uint32_t index)
+{
+    const BookLevel& level = m_levels[index];
+    if (level.head != NIL || level.displayed > EPSILON)
+    {
+        return;
+    }
+    if (level.prev != NIL)
+    {
+        m_levels[level.prev].next = level.next;
+    }
+    else
+    {
+        side.best = level.next;
+    }
+    if (level.next != NIL)
+    {
+        m_levels[level.next].prev = level.prev;
+    }
+    else
+    {
+        side.worst = level.prev;
+    }
+    side.levels.erase(level.ticks);
+    m_free_levels.push_back(index);
+}
+
+// Less displayed size means some of what was ahead has gone; what joined since queues behind us
+void MatchingEngine::SetDisplayed(const uint32_t index, const double displayed) noexcept
+{
+    BookLevel& level = m_levels[index];
+    level.displayed = displayed;
+    for (uint32_t order = level.head; order != NIL; order = m_nodes[order].next)
+    {
+        m_nodes[order].queue_ahead = std::min(m_nodes[order].queue_ahead, displayed);
+    }
+}
+
+// Both lists run best first, so one merge pass updates, adds and empties levels. Prices beyond
+// the snapshot's depth are treated as empty.
+void MatchingEngine::MergeSnapshot(BookSide& side, const std::vector<PriceLevel>& snapshot)
+{
+    uint32_t level = side.best;
+    bool has_previous = false;
+    int64_t previous = 0;
+    for (const PriceLevel& entry : snapshot)
+    {
+        const int64_t ticks = ToTicks(entry.price);
+        if (has_previous && !IsBetter(side, previous, ticks))
+        {
+            continue;  // Out of order or duplicate price
+        }
+        has_previous = true;
+        previous = ticks;
+
+        while (level != NIL && IsBetter(side, m_levels[level].ticks, ticks))
+        {
+            const uint32_t next = m_levels[level].next;
+            SetDisplayed(level, 0.0);
+            ReleaseLevelIfEmpty(side, level);
+            level = next;
+        }
+        if (level != NIL && m_levels[level].ticks == ticks)
+        {
+            SetDisplayed(level, entry.amount);
+            level = m_levels[level].next;
+        }
+        else
+        {
+            m_levels[InsertLevel(side, ticks, level)].displayed = entry.amount;
+        }
+    }
+    while (level != NIL)
+    {
+        const uint32_t next = m_levels[level].next;
+        SetDisplayed(level, 0.0);
+        ReleaseLevelIfEmpty(side, level);
+        level = next;
+    }
+}
+
+void MatchingEngine::Enqueue(const uint32_t index, const uint32_t level_index)
+{
+    OrderNode& node = m_nodes[index];
+    BookLevel& level = m_levels[level_index];
+    node.level = level_index;
+    node.queue_ahead = level.displayed;
+    node.prev = level.tail;
+    node.next = NIL;
+    if (level.tail != NIL)
+    {
+        m_nodes[level.tail].next = index;
+    }
+    else
+    {
+        level.head = index;
+    }
+    level.tail = index;
+}
+
+// Leaves the level in place; callers release it once they are done walking it
+void MatchingEngine::Dequeue(const uint32_t index)
+{
+    OrderNode& node = m_nodes[index];
+    BookLevel& level = m_levels[node.level];
+    if (node.prev != NIL)
+    {
+        m_nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        level.head = node.next;
+    }
+    if (node.next != NIL)
+    {
+        m_nodes[node.next].prev = node.prev;
+    }
+    else
+    {
+        level.tail = node.prev;
+    }
+    node.level = NIL;
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void MatchingEngine::LinkStop(const uint32_t index)
+{
+    OrderNode& node = m_nodes[index];
+    node.prev = m_stops_tail;
+    node.next = NIL;
+    if (m_stops_tail != NIL)
+    {
+        m_nodes[m_stops_tail].next = index;
+    }
+    else
+    {
+        m_stops_head = index;
+    }
+    m_stops_tail = index;
+}
+
+void MatchingEngine::UnlinkStop(const uint32_t index)
+{
+    OrderNode& node = m_nodes[index];
+    if (node.prev != NIL)
+    {
+        m_nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        m_stops_head = node.next;
+    }
+    if (node.next != NIL)
+    {
+        m_nodes[node.next].prev = node.prev;
+    }
+    else
+    {
+        m_stops_tail = node.prev;
+    }
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+double MatchingEngine::AvailableLiquidity(const BookSide& side, const bool has_limit,
+                                          const int64_t limit_ticks, const double wanted) const
+{
+    double available = 0.0;
+    for (uint32_t index = side.best; index != NIL && available < wanted; index = m_levels[index].next)
+    {
+        const BookLevel& level = m_levels[index];
+        if (has_limit && IsBetter(side, limit_ticks, level.ticks))
+        {
+            break;
+        }
+        available += level.displayed;
+        for (uint32_t order = level.head; order != NIL; order = m_nodes[order].next)
+        {
+            available += m_nodes[order].amount - m_nodes[order].filled_amount;
+        }
+    }
+    return available;
+}
+
+// Works through one level in queue order: displayed size ahead of each of our orders, then the
+// order itself, then whatever displayed size is left. The taker is our aggressing order, or NIL
+// when a replayed trade is doing the consuming. Returns the quantity consumed.
+double MatchingEngine::ConsumeLevel(const uint32_t level_index, const double quantity, const uint32_t taker)
+{
+    const int64_t ticks = m_levels[level_index].ticks;
+    double remaining = quantity;
+    double consumed = 0.0;
+    double consumed_displayed = 0.0;
+
+    uint32_t index = m_levels[level_index].head;
+    while (index != NIL && remaining > EPSILON)
+    {
+        const uint32_t next = m_nodes[index].next;
+        const double ahead = m_nodes[index].queue_ahead - consumed_displayed;
+        if (ahead > EPSILON)
+        {
+            const double quantity_ahead = std::min(remaining, ahead);
+            consumed_displayed += quantity_ahead;
+            consumed += quantity_ahead;
+            remaining -= quantity_ahead;
+            if (taker != NIL)
+            {
+                Fill(taker, ticks, quantity_ahead);
+            }
+            if (remaining <= EPSILON)
+            {
+                break;
+            }
+        }
+
+        const double match = std::min(remaining, m_nodes[index].amount - m_nodes[index].filled_amount);
+        consumed += match;
+        remaining -= match;
+        if (taker != NIL)
+        {
+            Fill(taker, ticks, match);
+        }
+        Fill(index, ticks, match);
+        Emit(index);
+        Finish(index);
+        index = next;
+    }
+
+    BookLevel& level = m_levels[level_index];
+    const double rest = std::min(remaining, level.displayed - consumed_displayed);
+    if (rest > EPSILON)
+    {
+        consumed_displayed += rest;
+        consumed += rest;
+        if (taker != NIL)
+        {
+            Fill(taker, ticks, rest);
+        }
+    }
+
+    level.displayed = std::max(0.0, level.displayed - consumed_displayed);
+    for (uint32_t order = level.head; order != NIL; order = m_nodes[order].next)
+    {
+        m_nodes[order].queue_ahead = std::max(0.0, m_nodes[order].queue_ahead - consumed_displayed);
+    }
+    if (taker != NIL && consumed > EPSILON)
+    {
+        SetLastTrade(ticks);
+    }
+    return consumed;
+}
+
+void MatchingEngine::Fill(const uint32_t index, const int64_t ticks, const double quantity)
+{
+    OrderNode& node = m_nodes[index];
+    node.filled_amount += quantity;
+    node.filled_notional += ToPrice(ticks) * quantity;
+    if (node.amount - node.filled_amount <= EPSILON)
+    {
+        node.filled_amount = node.amount;
+        node.state = NodeState::FILLED;
+        if (node.level != NIL)
+        {
+            Dequeue(index);
+        }
+        --m_open_count;
+    }
+}
+
+// Matches an open order against the opposite side, then rests or cancels what is left
+void MatchingEngine::Execute(const uint32_t index)
+{
+    const bool is_buy = m_nodes[index].is_buy;
+    const bool has_limit = !m_nodes[index].is_market;
+    const int64_t limit_ticks = m_nodes[index].price_ticks;
+    const TimeInForce time_in_force = m_nodes[index].time_in_force;
+    BookSide& opposite = OppositeOf(is_buy);
+
+    double remaining = m_nodes[index].amount - m_nodes[index].filled_amount;
+    if (time_in_force == TimeInForce::FILL_OR_KILL &&
+        AvailableLiquidity(opposite, has_limit, limit_ticks, remaining) < remaining - EPSILON)
+    {
+        m_nodes[index].state = NodeState::CANCELLED;
+        --m_open_count;
+        return;
+    }
+
+    uint32_t level = opposite.best;
+    while (level != NIL && remaining > EPSILON)
+    {
+        if (has_limit && IsBetter(opposite, limit_ticks, m_levels[level].ticks))
+        {
+            break;
+        }
+        const uint32_t next = m_levels[level].next;
+        remaining -= ConsumeLevel(level, remaining, index);
+        ReleaseLevelIfEmpty(opposite, level);
+        level = next;
+    }
+
+    if (m_nodes[index].state != NodeState::OPEN)
+    {
+        return;  // Filled
+    }
+    if (!has_limit || time_in_force != TimeInForce::GOOD_TIL_CANCELLED)
+    {
+        m_nodes[index].state = NodeState::CANCELLED;
+        --m_open_count;
+        return;
+    }
+    Enqueue(index, GetOrCreateLevel(SideOf(is_buy), limit_ticks));
+}
+
+void MatchingEngine::SetLastTrade(const int64_t ticks)
+{
+    m_last_trade_ticks = ticks;
+    m_has_last_trade = true;
+}
+
+// Fires stops in the order they were placed; their own fills can move the last price and fire more
+void MatchingEngine::TriggerStops()
+{
+    while (m_has_last_trade && m_stops_head != NIL)
+    {
+        m_triggered.clear();
+        for (uint32_t index = m_stops_head; index != NIL; index = m_nodes[index].next)
+        {
+            const OrderNode& node = m_nodes[index];
+            const bool triggered = node.is_buy ? m_last_trade_ticks >= node.trigger_ticks
+                                               : m_last_trade_ticks <= node.trigger_ticks;
+            if (triggered)
+            {
+                m_triggered.push_back(index);
+            }
+        }
+        if (m_triggered.empty())
+        {
+            return;
+        }
+
+        for (const uint32_t index : m_triggered)
+        {
+            UnlinkStop(index);
+            m_nodes[index].state = NodeState::OPEN;
+        }
+        for (size_t position = 0; position < m_triggered.size(); ++position)
+        {
+            const uint32_t index = m_triggered[position];
+            Execute(index);
+            Emit(index);
+            Finish(index);
+        }
+    }
+}
+
+void MatchingEngine::Emit(const uint32_t index)
+{
+    const OrderNode& node = m_nodes[index];
+    char order_id[ORDER_ID_SIZE];
+    const int written = snprintf(order_id, sizeof(order_id), "%s%llu", ORDER_ID_PREFIX,
+                                 static_cast<unsigned long long>(MakeId(index)));
+
+    // Assigning into the reused event keeps its string capacity, so steady state does not allocate
+    m_event.order_id.assign(order_id, static_cast<size_t>(written));
+    m_event.instrument_name.assign(m_instrument_name);
+    m_event.order_type.assign(OrderManager::GetOrderTypeString(node.type));
+    switch (node.state)
+    {
+        case NodeState::UNTRIGGERED:
+            m_event.order_state.assign("untriggered");
+            break;
+        case NodeState::FILLED:
+            m_event.order_state.assign("filled");
+            break;
+        case NodeState::CANCELLED:
+            m_event.order_state.assign("cancelled");
+            break;
+        default:
+            m_event.order_state.assign("open");
+            break;
+    }
+    m_event.direction.assign(node.is_buy ? "buy" : "sell");
+    m_event.time_in_force.assign(TimeInForceString(static_cast<uint8_t>(node.time_in_force)));
+    m_event.label.assign(node.label);
+    m_event.amount = node.amount;
+    m_event.filled_amount = node.filled_amount;
+    m_event.price = node.is_market ? 0.0 : ToPrice(node.price_ticks);
+    m_event.average_price = node.filled_amount > EPSILON ? node.filled_notional / node.filled_amount : 0.0;
+    m_event.creation_timestamp = node.creation_timestamp;
+    m_event.last_update_timestamp = m_now;
+
+    if (m_update_handler)
+    {
+        m_update_handler(m_event);
+    }
+}
+
+void MatchingEngine::Acknowledge(const uint32_t index, const OrderCallback& callback)
+{
+    Emit(index);
+    if (callback)
+    {
+        callback(true, m_event);
+    }
+}
+
+void MatchingEngine::Finish(const uint32_t index)
+{
+    const NodeState state = m_nodes[index].state;
+    if (state == NodeState::FILLED || state == NodeState::CANCELLED)
+    {
+        ReleaseNode(index);
+    }
+}
+
+void MatchingEngine::Reject(const OrderCallback& callback, const char* reason)
+{
+    std::cerr << "Simulated order rejected: " << reason << "\n";
+    if (callback)
+    {
+        callback(false, Order{});
+    }
+}
+
+bool MatchingEngine::Enter() noexcept
+{
+    if (m_dispatching)
+    {
+        return false;
+    }
+    m_dispatching = true;
+    return true;
+}
+
+// Runs requests made from handlers during the call that is finishing, in the order they were made
+void MatchingEngine::Leave()
+{
+    for (size_t position = 0; position < m_deferred.size(); ++position)
+    {
+        DeferredRequest request = std::move(m_deferred[position]);
+        switch (request.kind)
+        {
+            case DeferredRequest::Kind::PLACE:
+                PlaceOrderNow(request.params, request.side, request.callback);
+                break;
+            case DeferredRequest::Kind::MODIFY:
+                ModifyOrderNow(request.order_id, request.new_amount, request.new_price, request.callback);
+                break;
+            case DeferredRequest::Kind::CANCEL:
+                CancelOrderNow(request.order_id, request.callback);
+                break;
+        }
+    }
+    m_deferred.clear();
+    m_dispatching = false;
+}
+
+bool MatchingEngine::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    if (params.instrument_name != m_instrument_name)
+    {
+        std::cerr << "Simulator for " << m_instrument_name << " cannot route " << params.instrument_name
+                  << "\n";
+        return false;
+    }
+    if (!Enter())
+    {
+        m_deferred.push_back({DeferredRequest::Kind::PLACE, params, side, {}, 0.0, 0.0, std::move(callback)});
+        return true;
+    }
+    PlaceOrderNow(params, side, callback);
+    Leave();
+    return true;
+}
+
+bool MatchingEngine::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    if (!Enter())
+    {
+        m_deferred.push_back(
+            {DeferredRequest::Kind::CANCEL, {}, {}, order_id, 0.0, 0.0, std::move(callback)});
+        return true;
+    }
+    CancelOrderNow(order_id, callback);
+    Leave();
+    return true;
+}
+
+bool MatchingEngine::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                                 OrderCallback callback)
+{
+    if (!Enter())
+    {
+        m_deferred.push_back(
+            {DeferredRequest::Kind::MODIFY, {}, {}, order_id, new_amount, new_price, std::move(callback)});
+        return true;
+    }
+    ModifyOrderNow(order_id, new_amount, new_price, callback);
+    Leave();
+    return true;
+}
+
+void MatchingEngine::PlaceOrderNow(const OrderParams& params, const std::string& side,
+                                   const OrderCallback& callback)
+{
+    uint8_t time_in_force;
+    const bool is_stop = params.type == OrderType::STOP_LIMIT || params.type == OrderType::STOP_MARKET;
+    const bool is_market = params.type == OrderType::MARKET || params.type == OrderType::STOP_MARKET;
+    if (side != "buy" && side != "sell")
+    {
+        return Reject(callback, "side must be buy or sell");
+    }
+    if (!(params.amount > 0.0))
+    {
+        return Reject(callback, "amount must be positive");
+    }
+    if (!is_market && !(params.price > 0.0))
+    {
+        return Reject(callback, "limit price must be positive");
+    }
+    if (!ParseTimeInForce(params.time_in_force, time_in_force))
+    {
+        return Reject(callback, "unknown time_in_force");
+    }
+
+    const bool is_buy = side == "buy";
+    const int64_t trigger_ticks = ToTicks(params.trigger_price);
+    if (is_stop)
+    {
+        if (!(params.trigger_price > 0.0))
+        {
+            return Reject(callback, "stop orders need a trigger price");
+        }
+        // Like the exchange, refuse stops that would fire straight away
+        if (m_has_last_trade &&
+            (is_buy ? m_last_trade_ticks >= trigger_ticks : m_last_trade_ticks <= trigger_ticks))
+        {
+            return Reject(callback, "trigger price is already through the last trade");
+        }
+    }
+
+    const uint32_t index = AcquireNode();
+    OrderNode& node = m_nodes[index];
+    node.label.assign(params.label);
+    node.price_ticks = is_market ? 0 : ToTicks(params.price);
+    node.trigger_ticks = trigger_ticks;
+    node.creation_timestamp = m_now;
+    node.amount = params.amount;
+    node.type = params.type;
+    node.time_in_force = static_cast<TimeInForce>(time_in_force);
+    node.is_buy = is_buy;
+    node.is_market = is_market;
+    ++m_open_count;
+
+    if (is_stop)
+    {
+        node.state = NodeState::UNTRIGGERED;
+        LinkStop(index);
+        Acknowledge(index, callback);
+        return;
+    }
+
+    node.state = NodeState::OPEN;
+    Execute(index);
+    Acknowledge(index, callback);
+    Finish(index);
+    TriggerStops();
+}
+
+void MatchingEngine::CancelOrderNow(const std::string& order_id, const OrderCallback& callback)
+{
+    OrderNode* node = Lookup(order_id);
+    if (node == nullptr)
+    {
+        return Reject(callback, "order not found");
+    }
+
+    const auto index = static_cast<uint32_t>(node - m_nodes.data());
+    if (node->state == NodeState::UNTRIGGERED)
+    {
+        UnlinkStop(index);
+    }
+    else
+    {
+        const uint32_t level = node->level;
+        Dequeue(index);
+        ReleaseLevelIfEmpty(SideOf(node->is_buy), level);
+    }
+    node->state = NodeState::CANCELLED;
+    --m_open_count;
+    Acknowledge(index, callback);
+    Finish(index);
+}
+
+// As on the exchange, an order keeps its place only if the price is unchanged and the size does
+// not grow; otherwise it is re-entered at the back of the queue and may trade straight away
+void MatchingEngine::ModifyOrderNow(const std::string& order_id, const double new_amount,
+                                    const double new_price, const OrderCallback& callback)
+{
+    OrderNode* node = Lookup(order_id);
+    if (node == nullptr)
+    {
+        return Reject(callback, "order not found");
+    }
+    if (new_amount <= node->filled_amount + EPSILON)
+    {
+        return Reject(callback, "amount must exceed the filled amount");
+    }
+    if (!node->is_market && !(new_price > 0.0))
+    {
+        return Reject(callback, "limit price must be positive");
+    }
+
+    const auto index = static_cast<uint32_t>(node - m_nodes.data());
+    const int64_t new_ticks = node->is_market ? 0 : ToTicks(new_price);
+    const bool keeps_priority = new_ticks == node->price_ticks && new_amount <= node->amount;
+    if (node->state == NodeState::UNTRIGGERED || keeps_priority)
+    {
+        node->amount = new_amount;
+        node->price_ticks = new_ticks;
+        Acknowledge(index, callback);
+        return;
+    }
+
+    const uint32_t level = node->level;
+    Dequeue(index);
+    ReleaseLevelIfEmpty(SideOf(node->is_buy), level);
+    node->amount = new_amount;
+    node->price_ticks = new_ticks;
+    Execute(index);
+    Acknowledge(index, callback);
+    Finish(index);
+    TriggerStops();
+}
+
+void MatchingEngine::OnOrderBook(const OrderBookSnapshot& book)
+{
+    if (book.instrument_name != m_instrument_name || !Enter())
+    {
+        return;
+    }
+    m_now = book.timestamp;
+    MergeSnapshot(m_bids, book.bids);
+    MergeSnapshot(m_asks, book.asks);
+    Leave();
+}
+
+// A replayed trade hits our side of the book: levels better than its price traded through and
+// fill completely; at its price the trade's size works through the queue in order
+void MatchingEngine::OnTrade(const Trade& trade)
+{
+    if (trade.instrument_name != m_instrument_name || !Enter())
+    {
+        return;
+    }
+    m_now = trade.timestamp;
+    const int64_t ticks = ToTicks(trade.price);
+    BookSide& side = trade.direction == "sell" ? m_bids : m_asks;
+
+    uint32_t level = side.best;
+    while (level != NIL && !IsBetter(side, ticks, m_levels[level].ticks))
+    {
+        const uint32_t next = m_levels[level].next;
+        const bool at_price = m_levels[level].ticks == ticks;
+        ConsumeLevel(level, at_price ? trade.amount : std::numeric_limits<double>::infinity(), NIL);
+        ReleaseLevelIfEmpty(side, level);
+        if (at_price)
+        {
+            break;
+        }
+        level = next;
+    }
+
+    SetLastTrade(ticks);
+    TriggerStops();
+    Leave();
+}
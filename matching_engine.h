@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exchange_types.h"
+#include "order_manager.h"
+
+using OrderUpdateHandler = std::function<void(const Order& order)>;
+
+// Deterministic price-time priority matching engine for one instrument, for backtesting strategies
+// against captured public data without touching testnet.
+//
+// Orders go in through the same OrderParams/OrderType inputs and OrderCallback acks as
+// OrderManager, and every state change is reported as an Order on the update handler, like the
+// private order stream. Replayed order book snapshots set the displayed liquidity at each price;
+// an order joining a level queues behind all of it, and replayed trades at that price work through
+// the queue ahead before filling our orders. Trades through a price fill everything resting there.
+// Stop orders trigger on the last trade price, replayed or simulated.
+//
+// Levels are intrusive lists of pooled order nodes, and no wall clock or randomness is involved:
+// the same inputs always produce the same events. Single-threaded. Handlers may call back into
+// the engine; those requests run once the current one has finished, as a live reply would.
+class MatchingEngine
+{
+  private:
+    static constexpr uint32_t NIL = ~uint32_t{0};
+    static constexpr size_t ORDER_ID_SIZE = 32;
+
+    enum class TimeInForce : uint8_t
+    {
+        GOOD_TIL_CANCELLED,
+        IMMEDIATE_OR_CANCEL,
+        FILL_OR_KILL
+    };
+
+    enum class NodeState : uint8_t
+    {
+        FREE,
+        UNTRIGGERED,
+        OPEN,
+        FILLED,
+        CANCELLED
+    };
+
+    struct OrderNode
+    {
+        std::string label;
+        int64_t price_ticks{0};
+        int64_t trigger_ticks{0};
+        int64_t creation_timestamp{0};
+        double amount{0.0};
+        double filled_amount{0.0};
+        double filled_notional{0.0};
+        double queue_ahead{0.0};  // Displayed liquidity still ahead of this order at its level
+        uint32_t generation{0};
+        uint32_t level{NIL};
+        uint32_t prev{NIL};  // Within the level queue or the stop list
+        uint32_t next{NIL};
+        OrderType type{OrderType::LIMIT};
+        TimeInForce time_in_force{TimeInForce::GOOD_TIL_CANCELLED};
+        NodeState state{NodeState::FREE};
+        bool is_buy{false};
+        bool is_market{false};
+    };
+
+    struct BookLevel
+    {
+        int64_t ticks{0};
+        double displayed{0.0};  // From the latest snapshot, less what has traded since
+        uint32_t head{NIL};
+        uint32_t tail{NIL};
+        uint32_t prev{NIL};  // Towards the best price
+        uint32_t next{NIL};
+    };
+
+    struct BookSide
+    {
+        bool is_bid;
+        uint32_t best{NIL};
+        uint32_t worst{NIL};
+        std::unordered_map<int64_t, uint32_t> levels;
+    };
+
+    struct DeferredRequest
+    {
+        enum class Kind : uint8_t
+        {
+            PLACE,
+            MODIFY,
+            CANCEL
+        } kind;
+        OrderParams params;
+        std::string side;
+        std::string order_id;
+        double new_amount;
+        double new_price;
+        OrderCallback callback;
+    };
+
+    std::string m_instrument_name;
+    double m_tick_size;
+    std::vector<OrderNode> m_nodes;
+    std::vector<uint32_t> m_free_nodes;
+    std::vector<BookLevel> m_levels;
+    std::vector<uint32_t> m_free_levels;
+    BookSide m_bids{true, NIL, NIL, {}};
+    BookSide m_asks{false, NIL, NIL, {}};
+    uint32_t m_stops_head{NIL};
+    uint32_t m_stops_tail{NIL};
+    std::vector<uint32_t> m_triggered;
+    size_t m_open_count{0};
+    int64_t m_last_trade_ticks{0};
+    bool m_has_last_trade{false};
+    int64_t m_now{0};  // Timestamp of the latest replayed event, in ms
+
+    OrderUpdateHandler m_update_handler;
+    Order m_event;  // Reused for every update
+    std::vector<DeferredRequest> m_deferred;
+    bool m_dispatching{false};
+
+    int64_t ToTicks(double price) const noexcept;
+    double ToPrice(int64_t ticks) const noexcept;
+    static bool IsBetter(const BookSide& side, int64_t lhs, int64_t rhs) noexcept;
+    BookSide& SideOf(bool is_buy) noexcept;
+    BookSide& OppositeOf(bool is_buy) noexcept;
+
+    uint32_t AcquireNode();
+    void ReleaseNode(uint32_t index);
+    uint64_t MakeId(uint32_t index) const noexcept;
+    OrderNode* Lookup(const std::string& order_id) noexcept;
+
+    uint32_t InsertLevel(BookSide& side, int64_t ticks, uint32_t before);
+    uint32_t GetOrCreateLevel(BookSide& side, int64_t ticks);
+    void ReleaseLevelIfEmpty(BookSide& side, uint32_t level);
+    void SetDisplayed(uint32_t level, double displayed) noexcept;
+    void MergeSnapshot(BookSide& side, const std::vector<PriceLevel>& snapshot);
+
+    void Enqueue(uint32_t index, uint32_t level);
+    void Dequeue(uint32_t index);
+    void LinkStop(uint32_t index);
+    void UnlinkStop(uint32_t index);
+
+    double AvailableLiquidity(const BookSide& side, bool has_limit, int64_t limit_ticks, double wanted) const;
+    double ConsumeLevel(uint32_t level, double quantity, uint32_t taker);
+    void Fill(uint32_t index, int64_t ticks, double quantity);
+    void Execute(uint32_t index);
+    void SetLastTrade(int64_t ticks);
+    void TriggerStops();
+
+    void Emit(uint32_t index);
+    void Acknowledge(uint32_t index, const OrderCallback& callback);
+    void Finish(uint32_t index);
+    static void Reject(const OrderCallback& callback, const char* reason);
+
+    void PlaceOrderNow(const OrderParams& params, const std::string& side, const OrderCallback& callback);
+    void CancelOrderNow(const std::string& order_id, const OrderCallback& callback);
+    void ModifyOrderNow(const std::string& order_id, double new_amount, double new_price,
+                        const OrderCallback& callback);
+    bool Enter() noexcept;
+    void Leave();
+
+  public:
+    MatchingEngine(std::string instrument_name, double tick_size, size_t capacity);
+
+    void SetOrderUpdateHandler(OrderUpdateHandler handler);
+
+    // Same contract as OrderManager: false if the request could not be sent, otherwise the
+    // callback reports the order as the exchange would after processing it
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+
+    // Replay input; events for other instruments are ignored
+    void OnOrderBook(const OrderBookSnapshot& book);
+    void OnTrade(const Trade& trade);
+
+    size_t GetOpenOrderCount() const noexcept;
+};
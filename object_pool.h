@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct PoolStats
+{
+    size_t capacity{0};  // Objects the pool has storage for
+    size_t in_use{0};
+    uint64_t block_allocations{0};  // Times the pool grew, the only time it touches the heap
+    uint64_t acquired{0};
+    uint64_t reused{0};  // Acquisitions served from a released object rather than fresh storage
+};
+
+// Recycles objects of one type so that once the pool has grown to the peak number in flight,
+// Acquire and Release never touch the heap. Objects are created BLOCK_SIZE at a time and live as
+// long as the pool; a released object keeps its members' storage (strings and vectors keep their
+// capacity) and comes back from Acquire as it was left, so callers reset what they use.
+// Single-threaded.
+template <typename T, size_t BLOCK_SIZE = 64>
+class ObjectPool
+{
+  private:
+    std::vector<std::unique_ptr<T[]>> m_blocks;
+    std::vector<T*> m_free;
+    size_t m_next_in_block{BLOCK_SIZE};  // Never-used objects left in the newest block start here
+    PoolStats m_stats;
+
+  public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    T* Acquire()
+    {
+        ++m_stats.acquired;
+        ++m_stats.in_use;
+        if (!m_free.empty())
+        {
+            T* const object = m_free.back();
+            m_free.pop_back();
+            ++m_stats.reused;
+            return object;
+        }
+        if (m_next_in_block == BLOCK_SIZE)
+        {
+            m_blocks.push_back(std::make_unique<T[]>(BLOCK_SIZE));
+            m_next_in_block = 0;
+            m_stats.capacity += BLOCK_SIZE;
+            ++m_stats.block_allocations;
+            // Sized up front so Release never allocates
+            m_free.reserve(m_stats.capacity);
+        }
+        return &m_blocks.back()[m_next_in_block++];
+    }
+
+    // Only objects from this pool, once each
+    void Release(T* object) noexcept
+    {
+        --m_stats.in_use;
+        m_free.push_back(object);
+    }
+
+    const PoolStats& GetStats() const noexcept
+    {
+        return m_stats;
+    }
+};
@@ -0,0 +1,527 @@
+#include "order_entry_socket.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+#include "response_decoder.h"
+
+OrderEntrySocket::OrderEntrySocket() : OrderEntrySocket("api_key.txt", "api_secret.txt")
+{
+}
+
+OrderEntrySocket::OrderEntrySocket(const std::string& key_file_path, const std::string& secret_file_path)
+    : m_api_credentials(key_file_path, secret_file_path)
+{
+    PrepareCancelAll();
+}
+
+OrderEntrySocket::~OrderEntrySocket()
+{
+    Disconnect();
+}
+
+int OrderEntrySocket::FormatPlaceOrderRequest(char* buffer, const size_t size, const uint64_t id,
+                                              const OrderParams& params, const std::string& side)
+{
+    const char* method = side == "buy" ? "buy" : "sell";
+    const auto request_id = static_cast<unsigned long long>(id);
+    if (params.type == OrderType::LIMIT)
+    {
+        return snprintf(buffer, size,
+                        "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/%s\",\"params\":{\"amount\":%.6f,"
+                        "\"instrument_name\":\"%s\",\"label\":\"%s\",\"price\":%.2f,\"type\":\"limit\"}}",
+                        request_id, method, params.amount, params.instrument_name.c_str(), params.label.c_str(),
+                        params.price);
+    }
+    if (params.type == OrderType::MARKET)
+    {
+        return snprintf(buffer, size,
+                        "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/%s\",\"params\":{\"amount\":%.6f,"
+                        "\"instrument_name\":\"%s\",\"label\":\"%s\",\"type\":\"market\"}}",
+                        request_id, method, params.amount, params.instrument_name.c_str(), params.label.c_str());
+    }
+    return -1;
+}
+
+int OrderEntrySocket::FormatCancelOrderRequest(char* buffer, const size_t size, const uint64_t id,
+                                               const std::string& order_id)
+{
+    return snprintf(buffer, size,
+                    "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/cancel\","
+                    "\"params\":{\"order_id\":\"%s\"}}",
+                    static_cast<unsigned long long>(id), order_id.c_str());
+}
+
+int OrderEntrySocket::FormatModifyOrderRequest(char* buffer, const size_t size, const uint64_t id,
+                                               const std::string& order_id, const double new_amount,
+                                               const double new_price)
+{
+    return snprintf(buffer, size,
+                    "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/edit\",\"params\":{\"order_id\":\"%s\","
+                    "\"amount\":%.6f,\"price\":%.2f}}",
+                    static_cast<unsigned long long>(id), order_id.c_str(), new_amount, new_price);
+}
+
+void OrderEntrySocket::Connect()
+{
+    m_stopping = false;
+    CancelTimer();
+
+    const auto req = drogon::HttpRequest::newHttpRequest();
+    req->setPath(PATH);
+    req->setMethod(drogon::Get);
+
+    m_client = drogon::WebSocketClient::newWebSocketClient(HOST);
+    m_client->setMessageHandler(
+        [this](std::string&& message, const drogon::WebSocketClientPtr&, const drogon::WebSocketMessageType& type)
+        {
+            if (type == drogon::WebSocketMessageType::Text)
+            {
+                HandleMessage(message);
+            }
+        });
+    m_client->setConnectionClosedHandler([this](const drogon::WebSocketClientPtr&) { HandleClosed(); });
+    m_client->connectToServer(req,
+                              [this](const drogon::ReqResult& result, const drogon::HttpResponsePtr&,
+                                     const drogon::WebSocketClientPtr&)
+                              {
+                                  if (result != drogon::ReqResult::Ok)
+                                  {
+                                      std::cerr << "Order entry socket failed to connect\n";
+                                      ScheduleReconnect();
+                                      return;
+                                  }
+                                  m_connected = true;
+                                  m_last_message = std::chrono::steady_clock::now();
+                                  Authenticate();
+                              });
+}
+
+void OrderEntrySocket::Disconnect()
+{
+    m_stopping = true;
+    CancelTimer();
+    if (m_client)
+    {
+        m_client->stop();
+    }
+    HandleClosed();
+    m_client.reset();
+}
+
+bool OrderEntrySocket::IsReady() const noexcept
+{
+    return m_connected && m_authenticated;
+}
+
+void OrderEntrySocket::CancelTimer()
+{
+    if (m_client && m_timer_id != 0)
+    {
+        m_client->getLoop()->invalidateTimer(m_timer_id);
+    }
+    m_timer_id = 0;
+}
+
+void OrderEntrySocket::ScheduleReconnect()
+{
+    if (m_stopping || !m_client)
+    {
+        return;
+    }
+    CancelTimer();
+    m_timer_id = m_client->getLoop()->runAfter(RECONNECT_DELAY_SECONDS,
+                                               [this]()
+                                               {
+                                                   m_timer_id = 0;
+                                                   Connect();
+                                               });
+}
+
+// Client credentials rather than the shared access token, so the REST session's token is untouched
+void OrderEntrySocket::Authenticate()
+{
+    char buffer[BUFFER_SIZE];
+    m_auth_id = m_next_id++;
+    const int written = snprintf(buffer, BUFFER_SIZE,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"public/auth\","
+                                 "\"params\":{\"grant_type\":\"client_credentials\",\"client_id\":\"%s\","
+                                 "\"client_secret\":\"%s\"}}",
+                                 static_cast<unsigned long long>(m_auth_id), m_api_credentials.GetApiKey().c_str(),
+                                 m_api_credentials.GetApiSecret().c_str());
+    if (written < 0 || written >= static_cast<int>(BUFFER_SIZE))
+    {
+        std::cerr << "Buffer overflow in authentication request formatting\n";
+        return;
+    }
+    m_client->getConnection()->send(buffer, static_cast<uint64_t>(written));
+}
+
+// Once per connection, after its first authentication
+void OrderEntrySocket::ConfigureSession()
+{
+    m_session_configured = true;
+    if (m_cancel_on_disconnect)
+    {
+        SendCancelOnDisconnect();
+    }
+    if (m_heartbeat_interval > 0)
+    {
+        SendHeartbeatInterval();
+    }
+    if (!m_order_update_handlers.empty())
+    {
+        SubscribeOrderUpdates();
+    }
+}
+
+// Connection scope: the exchange acts when this connection drops, whatever the other sessions do
+void OrderEntrySocket::SendCancelOnDisconnect()
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const bool enabled = m_cancel_on_disconnect;
+    const int written = snprintf(buffer, BUFFER_SIZE,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/%s_cancel_on_disconnect\","
+                                 "\"params\":{\"scope\":\"connection\"}}",
+                                 static_cast<unsigned long long>(id), enabled ? "enable" : "disable");
+    PendingRequest pending;
+    pending.ack_callback = [this, enabled](const bool success)
+    {
+        if (!success)
+        {
+            std::cerr << "Order entry socket failed to " << (enabled ? "enable" : "disable")
+                      << " cancel-on-disconnect\n";
+            return;
+        }
+        m_cancel_on_disconnect_active = enabled;
+    };
+    Send(buffer, written, id, std::move(pending));
+}
+
+void OrderEntrySocket::SendHeartbeatInterval()
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written =
+        m_heartbeat_interval > 0
+            ? snprintf(buffer, BUFFER_SIZE,
+                       "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"public/set_heartbeat\","
+                       "\"params\":{\"interval\":%d}}",
+                       static_cast<unsigned long long>(id), m_heartbeat_interval)
+            : snprintf(buffer, BUFFER_SIZE,
+                       "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"public/disable_heartbeat\",\"params\":{}}",
+                       static_cast<unsigned long long>(id));
+    PendingRequest pending;
+    pending.ack_callback = [](const bool success)
+    {
+        if (!success)
+        {
+            std::cerr << "Order entry socket failed to set the heartbeat interval\n";
+        }
+    };
+    Send(buffer, written, id, std::move(pending));
+}
+
+// Subscriptions belong to the connection, so this goes out again after every reconnect
+void OrderEntrySocket::SubscribeOrderUpdates()
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written = snprintf(buffer, BUFFER_SIZE,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/subscribe\","
+                                 "\"params\":{\"channels\":[\"user.orders.any.any.raw\"]}}",
+                                 static_cast<unsigned long long>(id));
+    PendingRequest pending;
+    pending.ack_callback = [](const bool success)
+    {
+        if (!success)
+        {
+            std::cerr << "Order entry socket failed to subscribe to order updates\n";
+        }
+    };
+    Send(buffer, written, id, std::move(pending));
+}
+
+// The exchange closes the connection if a test request goes unanswered
+void OrderEntrySocket::AnswerTestRequest()
+{
+    char buffer[BUFFER_SIZE];
+    const int written = snprintf(buffer, BUFFER_SIZE,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"public/test\",\"params\":{}}",
+                                 static_cast<unsigned long long>(m_next_id++));
+    if (m_connected && written > 0 && written < static_cast<int>(BUFFER_SIZE))
+    {
+        m_client->getConnection()->send(buffer, static_cast<uint64_t>(written));
+    }
+}
+
+// Formatted ahead of the trigger, so a kill switch pays for one write per session
+void OrderEntrySocket::PrepareCancelAll()
+{
+    m_cancel_all_id = m_next_id++;
+    m_cancel_all_length =
+        snprintf(m_cancel_all_request, sizeof(m_cancel_all_request),
+                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"private/cancel_all\",\"params\":{}}",
+                 static_cast<unsigned long long>(m_cancel_all_id));
+}
+
+void OrderEntrySocket::HandleMessage(const std::string& message)
+{
+    m_last_message = std::chrono::steady_clock::now();
+    uint64_t id = 0;
+    if (!ResponseDecoder::DecodeResponseId(message, id))
+    {
+        std::string_view channel;
+        std::string_view data;
+        if (ResponseDecoder::DecodeSubscription(message, channel, data))
+        {
+            if (channel.compare(0, 12, "user.orders.") != 0)
+            {
+                return;
+            }
+            if (!ResponseDecoder::DecodeOrderUpdate(data, m_update))
+            {
+                std::cerr << "Order entry socket failed to parse order update: " << channel << "\n";
+                return;
+            }
+            for (const OrderUpdateHandler& handler : m_order_update_handlers)
+            {
+                handler(m_update);
+            }
+            return;
+        }
+        bool test_request = false;
+        if (ResponseDecoder::DecodeHeartbeat(message, test_request) && test_request)
+        {
+            AnswerTestRequest();
+        }
+        return;  // Other notifications
+    }
+
+    if (id == m_auth_id)
+    {
+        AuthResult auth;
+        m_authenticated = ResponseDecoder::DecodeAuthResult(message, auth);
+        CancelTimer();
+        if (!m_authenticated)
+        {
+            // Backs off so bad credentials or a rate limit do not turn into a request storm
+            std::cerr << "Order entry socket failed to authenticate; retrying in " << m_auth_retry_seconds << "s\n";
+            m_timer_id = m_client->getLoop()->runAfter(m_auth_retry_seconds,
+                                                       [this]()
+                                                       {
+                                                           m_timer_id = 0;
+                                                           Authenticate();
+                                                       });
+            m_auth_retry_seconds = std::min(m_auth_retry_seconds * 2.0, MAX_AUTH_RETRY_SECONDS);
+            return;
+        }
+        m_auth_retry_seconds = MIN_AUTH_RETRY_SECONDS;
+
+        // Renew well before the token lapses; the session stays usable throughout
+        const double renew_seconds = auth.expires_in > 0 ? static_cast<double>(auth.expires_in) * 0.8 : 600.0;
+        m_timer_id = m_client->getLoop()->runAfter(renew_seconds,
+                                                   [this]()
+                                                   {
+                                                       m_timer_id = 0;
+                                                       Authenticate();
+                                                   });
+        if (!m_session_configured)
+        {
+            ConfigureSession();
+        }
+        return;
+    }
+
+    const auto pending = std::find_if(m_pending.begin(), m_pending.end(),
+                                      [id](const PendingRequest& request) { return request.id == id; });
+    if (pending == m_pending.end())
+    {
+        return;
+    }
+    const PendingRequest request = std::move(*pending);
+    m_pending.erase(pending);
+
+    if (request.probe_callback)
+    {
+        request.probe_callback(true);
+        return;
+    }
+    if (request.cancel_all_callback)
+    {
+        int64_t cancelled = 0;
+        const bool success = ResponseDecoder::DecodeCancelAll(message, cancelled);
+        request.cancel_all_callback(success, cancelled);
+        return;
+    }
+    if (request.ack_callback)
+    {
+        request.ack_callback(ResponseDecoder::DecodeAck(message));
+        return;
+    }
+    const bool success = ResponseDecoder::DecodeOrder(message, m_reply);
+    if (request.order_callback)
+    {
+        request.order_callback(success, m_reply);
+    }
+}
+
+// Fails everything in flight; the exchange may still act on those requests
+void OrderEntrySocket::HandleClosed()
+{
+    const bool was_connected = m_connected;
+    m_connected = false;
+    m_authenticated = false;
+    m_session_configured = false;
+    m_cancel_on_disconnect_active = false;
+
+    // Callbacks may reconnect, send or disconnect again, so they run over a local list that no
+    // member refers to; its storage goes back to m_failing afterwards for the next drop
+    std::vector<PendingRequest> failing;
+    failing.swap(m_failing);
+    failing.swap(m_pending);
+    for (const PendingRequest& request : failing)
+    {
+        if (request.probe_callback)
+        {
+            request.probe_callback(false);
+        }
+        else if (request.cancel_all_callback)
+        {
+            request.cancel_all_callback(false, 0);
+        }
+        else if (request.ack_callback)
+        {
+            request.ack_callback(false);
+        }
+        else if (request.order_callback)
+        {
+            request.order_callback(false, Order{});
+        }
+    }
+    failing.clear();
+    if (failing.capacity() > m_failing.capacity())
+    {
+        m_failing.swap(failing);
+    }
+
+    if (was_connected && !m_stopping)
+    {
+        std::cerr << "Order entry socket disconnected; reconnecting\n";
+        if (m_disconnect_handler)
+        {
+            m_disconnect_handler();
+        }
+        ScheduleReconnect();
+    }
+}
+
+bool OrderEntrySocket::Send(const char* request, const int length, const uint64_t id, PendingRequest pending)
+{
+    if (length < 0 || length >= static_cast<int>(BUFFER_SIZE))
+    {
+        std::cerr << "Buffer overflow in request formatting\n";
+        return false;
+    }
+    if (!IsReady())
+    {
+        return false;
+    }
+    pending.id = id;
+    m_pending.push_back(std::move(pending));
+    m_client->getConnection()->send(request, static_cast<uint64_t>(length));
+    return true;
+}
+
+bool OrderEntrySocket::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written = FormatPlaceOrderRequest(buffer, BUFFER_SIZE, id, params, side);
+    return Send(buffer, written, id, {0, std::move(callback), nullptr, nullptr, nullptr});
+}
+
+bool OrderEntrySocket::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written = FormatCancelOrderRequest(buffer, BUFFER_SIZE, id, order_id);
+    return Send(buffer, written, id, {0, std::move(callback), nullptr, nullptr, nullptr});
+}
+
+bool OrderEntrySocket::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                                   OrderCallback callback)
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written = FormatModifyOrderRequest(buffer, BUFFER_SIZE, id, order_id, new_amount, new_price);
+    return Send(buffer, written, id, {0, std::move(callback), nullptr, nullptr, nullptr});
+}
+
+bool OrderEntrySocket::Ping(ProbeCallback callback)
+{
+    char buffer[BUFFER_SIZE];
+    const uint64_t id = m_next_id++;
+    const int written = snprintf(buffer, BUFFER_SIZE,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":%llu,\"method\":\"public/test\",\"params\":{}}",
+                                 static_cast<unsigned long long>(id));
+    return Send(buffer, written, id, {0, nullptr, std::move(callback), nullptr, nullptr});
+}
+
+bool OrderEntrySocket::CancelAll(CancelAllCallback callback)
+{
+    PendingRequest pending;
+    pending.cancel_all_callback = std::move(callback);
+    if (!Send(m_cancel_all_request, m_cancel_all_length, m_cancel_all_id, std::move(pending)))
+    {
+        return false;
+    }
+    PrepareCancelAll();  // For the next trigger, after this one is on the wire
+    return true;
+}
+
+void OrderEntrySocket::SetCancelOnDisconnect(const bool enabled)
+{
+    m_cancel_on_disconnect = enabled;
+    if (IsReady() && m_session_configured)
+    {
+        SendCancelOnDisconnect();
+    }
+}
+
+bool OrderEntrySocket::IsCancelOnDisconnectActive() const noexcept
+{
+    return m_cancel_on_disconnect_active;
+}
+
+void OrderEntrySocket::SetHeartbeatInterval(const int seconds)
+{
+    m_heartbeat_interval = seconds > 0 ? std::max(seconds, MIN_HEARTBEAT_INTERVAL_SECONDS) : 0;
+    if (IsReady() && m_session_configured)
+    {
+        SendHeartbeatInterval();
+    }
+}
+
+std::chrono::steady_clock::time_point OrderEntrySocket::GetLastMessageTime() const noexcept
+{
+    return m_last_message;
+}
+
+void OrderEntrySocket::SetDisconnectHandler(DisconnectHandler handler)
+{
+    m_disconnect_handler = std::move(handler);
+}
+
+void OrderEntrySocket::AddOrderUpdateHandler(OrderUpdateHandler handler)
+{
+    m_order_update_handlers.push_back(std::move(handler));
+    if (m_order_update_handlers.size() == 1 && IsReady() && m_session_configured)
+    {
+        SubscribeOrderUpdates();
+    }
+}
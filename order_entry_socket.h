@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <drogon/WebSocketClient.h>
+#include <trantor/net/EventLoop.h>
+
+#include "api_credentials.h"
+#include "order_manager.h"
+
+using DisconnectHandler = std::function<void()>;
+using OrderUpdateHandler = std::function<void(const Order& order)>;
+
+// Order entry over a Deribit JSON-RPC WebSocket session, with the same calls and callbacks as
+// OrderManager. The connection is authenticated with the account's API key, re-authenticated
+// before the token expires, and reconnected after a drop; requests in flight when it drops fail. A
+// refused authentication is retried on the same connection with exponential backoff.
+//
+// Requests return false without sending while the session is not connected and authenticated.
+// Replies are matched to requests by JSON-RPC id and run on drogon's main loop; call from that
+// loop too.
+//
+// In-flight requests and the decoded reply live in buffers that keep their capacity, so once warm
+// a request and its reply do not allocate beyond what the caller's callback itself holds.
+//
+// Cancel-on-disconnect and exchange heartbeats, when enabled, are set up again on every new
+// connection, and so is the private order update subscription once a handler is registered. The
+// cancel_all request is formatted ahead of time so sending it is a single write.
+class OrderEntrySocket
+{
+    friend class OrderEntrySocketBenchmark;  // benchmarks/ drives HandleMessage without a connection
+
+  private:
+    static constexpr size_t BUFFER_SIZE = 1024;
+    static constexpr const char* HOST = "wss://test.deribit.com";
+    static constexpr const char* PATH = "/ws/api/v2";
+    static constexpr double RECONNECT_DELAY_SECONDS = 1.0;
+    static constexpr double MIN_AUTH_RETRY_SECONDS = 1.0;  // Doubles on each failed attempt
+    static constexpr double MAX_AUTH_RETRY_SECONDS = 60.0;
+    static constexpr int MIN_HEARTBEAT_INTERVAL_SECONDS = 10;  // Deribit's lower bound
+
+    struct PendingRequest
+    {
+        uint64_t id{0};
+        OrderCallback order_callback;
+        ProbeCallback probe_callback;  // Any reply counts as success
+        CancelAllCallback cancel_all_callback;
+        ProbeCallback ack_callback;  // Success unless the reply is an error
+    };
+
+    ApiCredentials m_api_credentials;
+    drogon::WebSocketClientPtr m_client;
+    std::vector<PendingRequest> m_pending;  // In send order, which is mostly reply order too
+    std::vector<PendingRequest> m_failing;  // Spare storage swapped in for m_pending when the session drops
+    Order m_reply;
+    Order m_update;  // Decoded order update notification, reused
+    uint64_t m_next_id{1};
+    uint64_t m_auth_id{0};
+    bool m_connected{false};
+    bool m_authenticated{false};
+    bool m_session_configured{false};  // Cancel-on-disconnect and heartbeats sent on this connection
+    bool m_stopping{false};
+    trantor::TimerId m_timer_id{0};  // Reconnect or re-authentication, whichever is due
+    double m_auth_retry_seconds{MIN_AUTH_RETRY_SECONDS};
+
+    bool m_cancel_on_disconnect{false};
+    bool m_cancel_on_disconnect_active{false};  // Confirmed by the exchange for this connection
+    int m_heartbeat_interval{0};
+    std::chrono::steady_clock::time_point m_last_message;
+    DisconnectHandler m_disconnect_handler;
+    std::vector<OrderUpdateHandler> m_order_update_handlers;
+
+    char m_cancel_all_request[128];
+    int m_cancel_all_length{0};
+    uint64_t m_cancel_all_id{0};
+
+    void Authenticate();
+    void ConfigureSession();
+    void SendCancelOnDisconnect();
+    void SendHeartbeatInterval();
+    void SubscribeOrderUpdates();
+    void AnswerTestRequest();
+    void PrepareCancelAll();
+    void ScheduleReconnect();
+    void HandleMessage(const std::string& message);
+    void HandleClosed();
+    bool Send(const char* request, int length, uint64_t id, PendingRequest pending);
+    void CancelTimer();
+
+  public:
+    OrderEntrySocket();
+    // For accounts other than the default one in api_key.txt and api_secret.txt
+    OrderEntrySocket(const std::string& key_file_path, const std::string& secret_file_path);
+    ~OrderEntrySocket();
+    OrderEntrySocket(const OrderEntrySocket&) = delete;
+    OrderEntrySocket& operator=(const OrderEntrySocket&) = delete;
+
+    // JSON-RPC request formatting, split out so it can be benchmarked without a connection. Return
+    // the snprintf result: negative on error or unsupported type, >= size when truncated.
+    static int FormatPlaceOrderRequest(char* buffer, size_t size, uint64_t id, const OrderParams& params,
+                                       const std::string& side);
+    static int FormatCancelOrderRequest(char* buffer, size_t size, uint64_t id, const std::string& order_id);
+    static int FormatModifyOrderRequest(char* buffer, size_t size, uint64_t id, const std::string& order_id,
+                                        double new_amount, double new_price);
+
+    void Connect();
+    void Disconnect();
+    bool IsReady() const noexcept;
+
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+
+    // public/test over this session, used as a latency and health probe
+    bool Ping(ProbeCallback callback);
+
+    // private/cancel_all over this session: every open order of the account
+    bool CancelAll(CancelAllCallback callback = nullptr);
+
+    // Has the exchange cancel every order of the account when this connection drops. Applied at
+    // once if the session is up, and on every reconnect.
+    void SetCancelOnDisconnect(bool enabled);
+    bool IsCancelOnDisconnectActive() const noexcept;
+
+    // Has the exchange send a heartbeat every interval (10 seconds at least; 0 turns them off) and
+    // answers its test requests, so a silent session can be told apart from a quiet market
+    void SetHeartbeatInterval(int seconds);
+    std::chrono::steady_clock::time_point GetLastMessageTime() const noexcept;
+
+    // Runs when an established connection drops, before the reconnect is scheduled
+    void SetDisconnectHandler(DisconnectHandler handler);
+
+    // Subscribes to user.orders.any.any.raw, the account's order updates on every instrument, and
+    // hands each one to the handlers. Updates sent while the connection was down are not replayed;
+    // reconcile against the exchange after a reconnect.
+    void AddOrderUpdateHandler(OrderUpdateHandler handler);
+};
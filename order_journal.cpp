@@ -0,0 +1,706 @@
+#include "order_journal.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+constexpr double EPSILON = 1e-9;
+
+template <size_t N>
+void CopyString(char (&destination)[N], const std::string& source) noexcept
+{
+    const size_t length = source.size() < N - 1 ? source.size() : N - 1;
+    std::memcpy(destination, source.data(), length);
+    destination[length] = '\0';
+}
+
+uint8_t EncodeOrderState(const std::string& order_state)
+{
+    if (order_state == "open")
+    {
+        return 1;
+    }
+    if (order_state == "untriggered")
+    {
+        return 2;
+    }
+    if (order_state == "filled")
+    {
+        return 3;
+    }
+    if (order_state == "cancelled")
+    {
+        return 4;
+    }
+    return order_state == "rejected" ? 5 : 0;
+}
+
+const char* DecodeOrderState(const uint8_t order_state)
+{
+    static constexpr const char* NAMES[] = {"", "open", "untriggered", "filled", "cancelled", "rejected"};
+    return order_state < 6 ? NAMES[order_state] : "";
+}
+
+bool IsLiveState(const uint8_t order_state)
+{
+    return order_state == 1 || order_state == 2;
+}
+
+// Whether get_positions for currency and kind would list the instrument. Futures are named like
+// "ETH-PERPETUAL" or "ETH-27DEC24", options like "ETH-27DEC24-2500-C", and spot pairs like "ETH_USDC";
+// linear instruments such as "ETH_USDC-PERPETUAL" come under their settlement currency, USDC.
+bool IsListedUnder(const std::string& instrument_name, const std::string& currency, const std::string& kind)
+{
+    const size_t base_end = instrument_name.find('-');
+    const std::string base = instrument_name.substr(0, base_end);
+    const size_t separator = base.find('_');
+    const std::string settlement = separator == std::string::npos ? base : base.substr(separator + 1);
+    if (!currency.empty() && currency != "any" && settlement != currency)
+    {
+        return false;
+    }
+
+    size_t dashes = 0;
+    for (const char character : instrument_name)
+    {
+        dashes += character == '-' ? 1 : 0;
+    }
+    if (kind.empty() || kind == "any")
+    {
+        return true;
+    }
+    if (kind == "future")
+    {
+        return dashes == 1;
+    }
+    if (kind == "option")
+    {
+        return dashes == 3;
+    }
+    return kind == "spot" && dashes == 0;
+}
+
+// Shared by the callbacks of one Reconcile; the report is delivered when the last one finishes
+struct ReconcileState
+{
+    size_t remaining{1};
+    bool success{true};
+    bool positions_listed{false};
+    ReconcileReport report;
+    std::vector<Position> positions;
+    std::function<void()> complete;
+
+    void Finish()
+    {
+        if (--remaining == 0)
+        {
+            complete();
+        }
+    }
+};
+}  // namespace
+
+OrderJournal::OrderJournal(const OrderManager& order_manager) : m_order_manager(order_manager)
+{
+}
+
+OrderJournal::~OrderJournal()
+{
+    Close();
+}
+
+void OrderJournal::SetCommitInterval(const std::chrono::milliseconds interval) noexcept
+{
+    m_commit_interval = interval;
+}
+
+uint32_t OrderJournal::Checksum(const JournalRecord& record) noexcept
+{
+    JournalRecord copy = record;
+    copy.checksum = 0;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&copy);
+    uint32_t hash = 2166136261u;
+    for (size_t index = 0; index < sizeof(copy); ++index)
+    {
+        hash = (hash ^ bytes[index]) * 16777619u;
+    }
+    return hash;
+}
+
+// The header takes the first record-sized block so records stay cache-line aligned
+size_t OrderJournal::GetFileSize(const uint64_t capacity) noexcept
+{
+    return static_cast<size_t>((capacity + 1) * sizeof(JournalRecord));
+}
+
+JournalRecord OrderJournal::MakeRecord(const JournalRecordType type, const uint64_t request_id)
+{
+    JournalRecord record;
+    std::memset(&record, 0, sizeof(record));  // Padding included, so checksums are reproducible
+    record.type = type;
+    record.request_id = request_id;
+    record.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+    return record;
+}
+
+JournalRecord OrderJournal::MakeOrderRecord(const uint64_t request_id, const Order& order)
+{
+    JournalRecord record = MakeRecord(JournalRecordType::ORDER_UPDATE, request_id);
+    record.direction = order.direction == "buy" ? 1 : order.direction == "sell" ? 2 : 0;
+    record.order_state = EncodeOrderState(order.order_state);
+    record.amount = order.amount;
+    record.filled_amount = order.filled_amount;
+    record.price = order.price;
+    record.average_price = order.average_price;
+    record.timestamp = order.last_update_timestamp != 0 ? order.last_update_timestamp : record.timestamp;
+    CopyString(record.order_id, order.order_id);
+    CopyString(record.instrument_name, order.instrument_name);
+    CopyString(record.label, order.label);
+    return record;
+}
+
+Order OrderJournal::ToOrder(const JournalRecord& record)
+{
+    Order order;
+    order.order_id = record.order_id;
+    order.instrument_name = record.instrument_name;
+    order.label = record.label;
+    order.order_state = DecodeOrderState(record.order_state);
+    order.direction = record.direction == 1 ? "buy" : record.direction == 2 ? "sell" : "";
+    order.amount = record.amount;
+    order.filled_amount = record.filled_amount;
+    order.price = record.price;
+    order.average_price = record.average_price;
+    order.last_update_timestamp = record.timestamp;
+    return order;
+}
+
+bool OrderJournal::Map(const std::string& path, const size_t capacity)
+{
+    if (!m_file.Open(path, GetFileSize(capacity)))
+    {
+        return false;
+    }
+    auto* header = static_cast<JournalHeader*>(m_file.GetAddress());
+    m_capacity = m_file.GetSize() / sizeof(JournalRecord) - 1;
+    if (header->magic == 0)
+    {
+        header->magic = JOURNAL_MAGIC;
+        header->version = JOURNAL_VERSION;
+        header->record_size = sizeof(JournalRecord);
+    }
+    else if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION ||
+             header->record_size != sizeof(JournalRecord))
+    {
+        std::cerr << "Not a version " << JOURNAL_VERSION << " order journal: " << path << "\n";
+        m_file.Close();
+        return false;
+    }
+    header->capacity = m_capacity;
+    m_records =
+        reinterpret_cast<JournalRecord*>(static_cast<char*>(m_file.GetAddress()) + sizeof(JournalRecord));
+    return true;
+}
+
+bool OrderJournal::Open(const std::string& path, const size_t capacity)
+{
+    Close();
+    if (capacity == 0 || !Map(path, capacity) || !Recover())
+    {
+        return false;
+    }
+    std::cout << "Recovered " << m_open_orders.size() << " open orders, " << m_positions.size()
+              << " positions and " << m_pending.size() << " pending requests from " << path << "\n";
+    if (m_next_sequence > 1 && !Compact(path, capacity))
+    {
+        std::cerr << "Journal compaction failed; continuing with the uncompacted journal\n";
+        if (m_file.GetAddress() == nullptr)
+        {
+            ResetState();
+            if (!Map(path, capacity) || !Recover())
+            {
+                return false;
+            }
+        }
+    }
+
+    m_stopping = false;
+    m_committer = std::thread([this]() { CommitLoop(); });
+    return true;
+}
+
+void OrderJournal::Close()
+{
+    if (m_committer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_one();
+        m_committer.join();  // The last pass flushes everything written
+    }
+    m_file.Close();
+    m_records = nullptr;
+    m_capacity = 0;
+    m_next_sequence = 1;
+    m_written.store(0, std::memory_order_relaxed);
+    m_durable.store(0, std::memory_order_relaxed);
+    m_full_reported = false;
+    ResetState();
+}
+
+void OrderJournal::ResetState()
+{
+    m_open_orders.clear();
+    m_progress.clear();
+    m_positions.clear();
+    m_pending.clear();
+}
+
+// Replays records up to the first slot that is empty, out of sequence or torn
+bool OrderJournal::Recover()
+{
+    uint64_t index = 0;
+    for (; index < m_capacity; ++index)
+    {
+        const JournalRecord& record = m_records[index];
+        if (record.sequence != index + 1 || record.checksum != Checksum(record))
+        {
+            break;
+        }
+        Apply(record);
+        if (record.request_id >= m_next_request_id)
+        {
+            m_next_request_id = record.request_id + 1;
+        }
+    }
+    if (index < m_capacity && m_records[index].sequence != 0)
+    {
+        std::cerr << "Order journal ends in a torn record at " << index + 1 << "; discarding the tail\n";
+    }
+
+    // Zero what follows so a stale tail can never be mistaken for new records
+    const size_t tail = static_cast<size_t>(m_capacity - index) * sizeof(JournalRecord);
+    std::memset(m_records + index, 0, tail);
+    m_next_sequence = index + 1;
+    m_written.store(index, std::memory_order_relaxed);
+    m_durable.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+// Writes the recovered state as a fresh journal beside the old one, then swaps it in
+bool OrderJournal::Compact(const std::string& path, const size_t capacity)
+{
+    const std::string compacted_path = path + ".compact";
+    {
+        MappedFile compacted;
+        if (!compacted.Open(compacted_path, GetFileSize(capacity)))
+        {
+            return false;
+        }
+        const size_t records = m_open_orders.size() + m_positions.size() + m_pending.size();
+        if (compacted.GetSize() < GetFileSize(records))
+        {
+            std::cerr << "Journal capacity " << capacity << " cannot hold the recovered state\n";
+            return false;
+        }
+        std::memset(compacted.GetAddress(), 0, compacted.GetSize());
+        auto* header = static_cast<JournalHeader*>(compacted.GetAddress());
+        header->magic = JOURNAL_MAGIC;
+        header->version = JOURNAL_VERSION;
+        header->record_size = sizeof(JournalRecord);
+        header->capacity = compacted.GetSize() / sizeof(JournalRecord) - 1;
+        auto* output = reinterpret_cast<JournalRecord*>(static_cast<char*>(compacted.GetAddress()) +
+                                                        sizeof(JournalRecord));
+
+        uint64_t sequence = 0;
+        const auto write = [&output, &sequence](JournalRecord record)
+        {
+            record.sequence = ++sequence;
+            record.checksum = Checksum(record);
+            output[sequence - 1] = record;
+        };
+        for (const auto& pending : m_pending)
+        {
+            write(pending.second);
+        }
+        for (const auto& order : m_open_orders)
+        {
+            write(MakeOrderRecord(0, order.second));
+        }
+        // Positions last, so replaying the open orders' fills does not count them twice
+        for (const auto& position : m_positions)
+        {
+            JournalRecord record = MakeRecord(JournalRecordType::POSITION, 0);
+            CopyString(record.instrument_name, position.first);
+            record.amount = position.second;
+            write(record);
+        }
+        if (!compacted.Flush(0, compacted.GetSize()))
+        {
+            return false;
+        }
+    }
+
+    m_file.Close();
+    if (!MappedFile::Replace(compacted_path, path))
+    {
+        return false;
+    }
+
+    // Reload from the compacted file so memory and disk agree exactly
+    ResetState();
+    return Map(path, capacity) && Recover();
+}
+
+bool OrderJournal::Append(JournalRecord& record)
+{
+    if (m_records == nullptr)
+    {
+        return false;
+    }
+    if (m_next_sequence > m_capacity)
+    {
+        if (!m_full_reported)
+        {
+            std::cerr << "Order journal is full; further order flow is not journalled\n";
+            m_full_reported = true;
+        }
+        return false;
+    }
+    record.sequence = m_next_sequence;
+    record.checksum = Checksum(record);
+    m_records[m_next_sequence - 1] = record;
+    m_written.store(m_next_sequence, std::memory_order_release);
+    ++m_next_sequence;
+    return true;
+}
+
+void OrderJournal::Apply(const JournalRecord& record)
+{
+    switch (record.type)
+    {
+        case JournalRecordType::PLACE_REQUEST:
+        case JournalRecordType::MODIFY_REQUEST:
+        case JournalRecordType::CANCEL_REQUEST:
+            m_pending[record.request_id] = record;
+            break;
+        case JournalRecordType::REQUEST_FAILED:
+            m_pending.erase(record.request_id);
+            break;
+        case JournalRecordType::POSITION:
+            m_positions[record.instrument_name] = record.amount;
+            break;
+        case JournalRecordType::RECONCILED:
+            for (auto pending = m_pending.begin(); pending != m_pending.end();)
+            {
+                pending = pending->first < record.request_id ? m_pending.erase(pending) : std::next(pending);
+            }
+            break;
+        case JournalRecordType::ORDER_UPDATE:
+        {
+            m_pending.erase(record.request_id);
+            if (record.order_id[0] == '\0')
+            {
+                break;
+            }
+            OrderProgress& progress = m_progress[record.order_id];
+            const bool is_live = IsLiveState(record.order_state);
+            if (record.timestamp < progress.last_update_timestamp || (progress.closed && is_live))
+            {
+                break;  // Older than what is already known
+            }
+            const double filled_delta = record.filled_amount - progress.filled_amount;
+            if (filled_delta > EPSILON)
+            {
+                m_positions[record.instrument_name] += record.direction == 2 ? -filled_delta : filled_delta;
+                progress.filled_amount = record.filled_amount;
+            }
+            progress.last_update_timestamp = record.timestamp;
+            progress.closed = !is_live;
+            if (is_live)
+            {
+                m_open_orders[record.order_id] = ToOrder(record);
+            }
+            else
+            {
+                m_open_orders.erase(record.order_id);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// A full journal stops recording but the in-memory state stays current
+void OrderJournal::Record(JournalRecord record)
+{
+    Append(record);
+    Apply(record);
+}
+
+OrderCallback OrderJournal::MakeReplyCallback(const uint64_t request_id, OrderCallback callback)
+{
+    return [this, request_id, callback = std::move(callback)](const bool success, const Order& order)
+    {
+        Record(success ? MakeOrderRecord(request_id, order)
+                       : MakeRecord(JournalRecordType::REQUEST_FAILED, request_id));
+        if (callback)
+        {
+            callback(success, order);
+        }
+    };
+}
+
+bool OrderJournal::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    const uint64_t request_id = m_next_request_id++;
+    JournalRecord record = MakeRecord(JournalRecordType::PLACE_REQUEST, request_id);
+    record.order_type = static_cast<uint8_t>(params.type);
+    record.direction = side == "buy" ? 1 : 2;
+    record.amount = params.amount;
+    record.price = params.price;
+    CopyString(record.instrument_name, params.instrument_name);
+    CopyString(record.label, params.label);
+    Record(record);
+
+    if (!m_order_manager.PlaceOrder(params, side, MakeReplyCallback(request_id, std::move(callback))))
+    {
+        Record(MakeRecord(JournalRecordType::REQUEST_FAILED, request_id));
+        return false;
+    }
+    return true;
+}
+
+bool OrderJournal::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    const uint64_t request_id = m_next_request_id++;
+    JournalRecord record = MakeRecord(JournalRecordType::CANCEL_REQUEST, request_id);
+    CopyString(record.order_id, order_id);
+    Record(record);
+
+    if (!m_order_manager.CancelOrder(order_id, MakeReplyCallback(request_id, std::move(callback))))
+    {
+        Record(MakeRecord(JournalRecordType::REQUEST_FAILED, request_id));
+        return false;
+    }
+    return true;
+}
+
+bool OrderJournal::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                               OrderCallback callback)
+{
+    const uint64_t request_id = m_next_request_id++;
+    JournalRecord record = MakeRecord(JournalRecordType::MODIFY_REQUEST, request_id);
+    CopyString(record.order_id, order_id);
+    record.amount = new_amount;
+    record.price = new_price;
+    Record(record);
+
+    if (!m_order_manager.ModifyOrder(order_id, new_amount, new_price,
+                                     MakeReplyCallback(request_id, std::move(callback))))
+    {
+        Record(MakeRecord(JournalRecordType::REQUEST_FAILED, request_id));
+        return false;
+    }
+    return true;
+}
+
+void OrderJournal::OnOrderUpdate(const Order& order)
+{
+    Record(MakeOrderRecord(0, order));
+}
+
+bool OrderJournal::Reconcile(const std::string& currency, const std::string& kind, ReconcileCallback callback)
+{
+    const auto state = std::make_shared<ReconcileState>();
+    state->remaining = 3;  // Open orders, positions, and this call
+
+    // Exchange positions already include every fill, so they go in after the order records do
+    state->complete = [this, state_pointer = state.get(), currency, kind, callback = std::move(callback)]()
+    {
+        for (const Position& position : state_pointer->positions)
+        {
+            const auto known = m_positions.find(position.instrument_name);
+            const double journal_size = known != m_positions.end() ? known->second : 0.0;
+            if (std::fabs(journal_size - position.size) > EPSILON)
+            {
+                JournalRecord record = MakeRecord(JournalRecordType::POSITION, 0);
+                CopyString(record.instrument_name, position.instrument_name);
+                record.amount = position.size;
+                Record(record);
+                ++state_pointer->report.positions_corrected;
+            }
+        }
+
+        // A position the exchange leaves out of a complete listing was closed while we were away
+        if (state_pointer->positions_listed)
+        {
+            std::unordered_set<std::string> listed;
+            listed.reserve(state_pointer->positions.size());
+            for (const Position& position : state_pointer->positions)
+            {
+                listed.insert(position.instrument_name);
+            }
+            std::vector<std::string> closed;
+            for (const auto& position : m_positions)
+            {
+                if (std::fabs(position.second) > EPSILON && listed.count(position.first) == 0 &&
+                    IsListedUnder(position.first, currency, kind))
+                {
+                    closed.push_back(position.first);
+                }
+            }
+            for (const std::string& instrument_name : closed)
+            {
+                JournalRecord record = MakeRecord(JournalRecordType::POSITION, 0);
+                CopyString(record.instrument_name, instrument_name);
+                record.amount = 0.0;
+                Record(record);
+                ++state_pointer->report.positions_corrected;
+            }
+        }
+        if (callback)
+        {
+            callback(state_pointer->success, state_pointer->report);
+        }
+    };
+
+    // Requests sent from here on may be missing from the open order list; their replies still count
+    const uint64_t first_unlisted_request = m_next_request_id;
+    const bool orders_requested = m_order_manager.GetOpenOrders(
+        [this, state, first_unlisted_request](const bool success, const std::vector<Order>& orders)
+        {
+            if (!success)
+            {
+                state->success = false;
+                state->Finish();
+                return;
+            }
+
+            std::unordered_set<std::string> listed;
+            listed.reserve(orders.size());
+            for (const Order& order : orders)
+            {
+                listed.insert(order.order_id);
+                state->report.orders_added += m_open_orders.count(order.order_id) == 0 ? 1 : 0;
+                Record(MakeOrderRecord(0, order));
+            }
+
+            // The open order list now accounts for every earlier request still awaiting a reply
+            for (const auto& pending : m_pending)
+            {
+                state->report.pending_requests += pending.first < first_unlisted_request ? 1 : 0;
+            }
+            Record(MakeRecord(JournalRecordType::RECONCILED, first_unlisted_request));
+
+            // Orders the exchange no longer lists finished while we were away; ask how
+            std::vector<std::string> finished;
+            for (const auto& order : m_open_orders)
+            {
+                if (listed.count(order.first) == 0)
+                {
+                    finished.push_back(order.first);
+                }
+            }
+            for (const std::string& order_id : finished)
+            {
+                ++state->remaining;
+                const bool requested = m_order_manager.GetOrderState(
+                    order_id,
+                    [this, state](const bool found, const Order& order)
+                    {
+                        if (found)
+                        {
+                            Record(MakeOrderRecord(0, order));
+                            state->report.orders_closed += m_open_orders.count(order.order_id) == 0 ? 1 : 0;
+                        }
+                        state->success = state->success && found;
+                        state->Finish();
+                    });
+                if (!requested)
+                {
+                    state->success = false;
+                    state->Finish();
+                }
+            }
+            state->Finish();
+        });
+    if (!orders_requested)
+    {
+        return false;
+    }
+
+    const bool positions_requested = m_order_manager.GetCurrentPositions(
+        currency, kind,
+        [state](const bool success, const std::vector<Position>& positions)
+        {
+            state->positions = positions;
+            state->positions_listed = success;
+            state->success = state->success && success;
+            state->Finish();
+        });
+    if (!positions_requested)
+    {
+        state->success = false;
+        state->Finish();
+    }
+    state->Finish();
+    return true;
+}
+
+// Group commit: one flush per interval covers every record appended since the previous one
+void OrderJournal::CommitLoop()
+{
+    bool stopping = false;
+    while (!stopping)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait_for(lock, m_commit_interval, [this]() { return m_stopping; });
+            stopping = m_stopping;
+        }
+        const uint64_t written = m_written.load(std::memory_order_acquire);
+        const uint64_t durable = m_durable.load(std::memory_order_relaxed);
+        const size_t length = static_cast<size_t>(written - durable) * sizeof(JournalRecord);
+        if (written > durable && m_file.Flush(GetFileSize(durable), length))
+        {
+            m_durable.store(written, std::memory_order_release);
+        }
+    }
+}
+
+const std::unordered_map<std::string, Order>& OrderJournal::GetOpenOrders() const noexcept
+{
+    return m_open_orders;
+}
+
+const std::unordered_map<std::string, double>& OrderJournal::GetPositions() const noexcept
+{
+    return m_positions;
+}
+
+size_t OrderJournal::GetPendingRequestCount() const noexcept
+{
+    return m_pending.size();
+}
+
+uint64_t OrderJournal::GetRecordCount() const noexcept
+{
+    return m_written.load(std::memory_order_relaxed);
+}
+
+uint64_t OrderJournal::GetDurableCount() const noexcept
+{
+    return m_durable.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "exchange_types.h"
+#include "mapped_file.h"
+#include "order_manager.h"
+
+enum class JournalRecordType : uint8_t
+{
+    NONE,
+    PLACE_REQUEST,
+    MODIFY_REQUEST,
+    CANCEL_REQUEST,
+    REQUEST_FAILED,  // Transport, HTTP or exchange error for request_id
+    ORDER_UPDATE,    // Reply to request_id, or a stream or reconciliation update when it is 0
+    POSITION,        // Net position for an instrument as reported by the exchange
+    RECONCILED       // The outcome of every request below request_id is reflected in later records
+};
+
+// Fixed-size journal entry, three cache lines. Strings are truncated to fit and NUL-terminated.
+struct JournalRecord
+{
+    uint64_t sequence;    // 1-based; a slot that does not hold sequence i + 1 ends the journal
+    uint64_t request_id;  // Links a request to its reply
+    int64_t timestamp;    // Exchange update time for order updates, else local wall clock; ms
+    uint32_t checksum;    // FNV-1a over the record with this field zeroed; catches torn writes
+    JournalRecordType type;
+    uint8_t order_type;   // OrderType of a place request
+    uint8_t direction;    // 1 buy, 2 sell
+    uint8_t order_state;  // 1 open, 2 untriggered, 3 filled, 4 cancelled, 5 rejected
+    double amount;
+    double filled_amount;
+    double price;
+    double average_price;
+    char order_id[32];
+    char instrument_name[32];
+    char label[64];
+};
+static_assert(sizeof(JournalRecord) == 192, "JournalRecord must stay three cache lines");
+
+struct ReconcileReport
+{
+    size_t orders_added{0};         // Open on the exchange, unknown to the journal
+    size_t orders_closed{0};        // Open in the journal, filled or cancelled on the exchange
+    size_t positions_corrected{0};
+    size_t pending_requests{0};     // Requests sent before Reconcile whose reply never made it into the journal
+};
+
+using ReconcileCallback = std::function<void(bool success, const ReconcileReport& report)>;
+
+// Append-only write-ahead journal of order flow, in a memory-mapped file of fixed-size records.
+//
+// Requests sent through the wrapped PlaceOrder/ModifyOrder/CancelOrder are recorded before they go
+// out, and their replies when they come back; OnOrderUpdate records private stream updates. A record
+// is in the page cache, and so survives the process dying, as soon as the call returns. A
+// background thread group-commits everything written since its last pass to disk every commit
+// interval, so the hot path never waits on the device.
+//
+// Open replays the journal into open orders, net positions and requests still awaiting a reply,
+// then compacts it to just that state. Reconcile fetches only what may have changed while the
+// process was down. Recording and reconciliation must run on drogon's main loop.
+class OrderJournal
+{
+  public:
+    static constexpr uint64_t JOURNAL_MAGIC = 0x4C4E524A534D454FULL;  // "OEMSJRNL"
+    static constexpr uint32_t JOURNAL_VERSION = 1;
+
+  private:
+    struct JournalHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t capacity;
+    };
+
+    // Turns repeated order updates into fill deltas, and drops updates older than what is known
+    struct OrderProgress
+    {
+        double filled_amount{0.0};
+        int64_t last_update_timestamp{0};
+        bool closed{false};
+    };
+
+    const OrderManager& m_order_manager;
+    MappedFile m_file;
+    JournalRecord* m_records{nullptr};
+    uint64_t m_capacity{0};
+    uint64_t m_next_sequence{1};
+    uint64_t m_next_request_id{1};
+    bool m_full_reported{false};
+
+    std::atomic<uint64_t> m_written{0};  // Records stored
+    std::atomic<uint64_t> m_durable{0};  // Records flushed to disk
+    std::chrono::milliseconds m_commit_interval{2};
+    std::thread m_committer;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stopping{false};
+
+    std::unordered_map<std::string, Order> m_open_orders;
+    std::unordered_map<std::string, OrderProgress> m_progress;
+    std::unordered_map<std::string, double> m_positions;
+    std::unordered_map<uint64_t, JournalRecord> m_pending;
+
+    static uint32_t Checksum(const JournalRecord& record) noexcept;
+    static size_t GetFileSize(uint64_t capacity) noexcept;
+    static JournalRecord MakeRecord(JournalRecordType type, uint64_t request_id);
+    static JournalRecord MakeOrderRecord(uint64_t request_id, const Order& order);
+    static Order ToOrder(const JournalRecord& record);
+
+    bool Map(const std::string& path, size_t capacity);
+    bool Recover();
+    void ResetState();
+    bool Compact(const std::string& path, size_t capacity);
+    bool Append(JournalRecord& record);
+    void Apply(const JournalRecord& record);
+    void Record(JournalRecord record);
+    OrderCallback MakeReplyCallback(uint64_t request_id, OrderCallback callback);
+    void CommitLoop();
+
+  public:
+    explicit OrderJournal(const OrderManager& order_manager);
+    ~OrderJournal();
+    OrderJournal(const OrderJournal&) = delete;
+    OrderJournal& operator=(const OrderJournal&) = delete;
+
+    // Takes effect at the next Open
+    void SetCommitInterval(std::chrono::milliseconds interval) noexcept;
+
+    // Capacity is the number of records the journal holds before appends fail; each restart
+    // compacts it back down to the live state
+    bool Open(const std::string& path, size_t capacity);
+    void Close();
+
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+    void OnOrderUpdate(const Order& order);
+
+    // Brings the recovered state up to date with the exchange: open orders in one request, a
+    // status request per journal order the exchange no longer lists, and positions for one
+    // currency and kind
+    bool Reconcile(const std::string& currency, const std::string& kind, ReconcileCallback callback);
+
+    const std::unordered_map<std::string, Order>& GetOpenOrders() const noexcept;
+    const std::unordered_map<std::string, double>& GetPositions() const noexcept;  // Signed, buy positive
+    size_t GetPendingRequestCount() const noexcept;
+    uint64_t GetRecordCount() const noexcept;
+    uint64_t GetDurableCount() const noexcept;
+};
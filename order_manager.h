@@ -1,60 +1,95 @@
-#pragma once
-
-#include <memory>
-#include <string>
-
-#include <drogon/HttpClient.h>
-
-#include "api_credentials.h"
-#include "token_manager.h"
-
-enum class OrderType
-{
-    LIMIT,
-    MARKET,
-    STOP_LIMIT,
-    STOP_MARKET
-};
-
-enum class InstrumentType
-{
-    SPOT,
-    FUTURES,
-    OPTION
-};
-
-struct OrderParams
-{
-    std::string instrument_name;  // e.g., "BTC-PERPETUAL", "BTC-28JUN24"
-    double amount;                // Amount in base currency
-    double price;                 // Optional for market orders
-    std::string label;            // Client order ID
-    OrderType type;               // Order type
-    std::string time_in_force;    // "good_til_cancelled", "fill_or_kill" "immediate_or_cancel"
-};
-
-class OrderManager
-{
-  private:
-    static constexpr size_t BUFFER_SIZE = 2048;
-    static constexpr const char* BASE_URL = "https://test.deribit.com";
-    static constexpr const char* API_PATH = "/api/v2/private/";
-    std::shared_ptr<drogon::HttpClient> m_client;
-    TokenManager& m_token_manager;
-    ApiCredentials m_api_credentials;
-
-  public:
-    OrderManager(TokenManager& token_manager);
-    bool RefreshTokenIfNeeded() const;
-
-    static std::string GetOrderTypeString(const OrderType& type);
-
-    bool PlaceOrder(const OrderParams& params, const std::string& side, std::string& response) const;
-    bool CancelOrder(const std::string& order_id, std::string& response) const;
-    bool ModifyOrder(const std::string& order_id, const double& new_amount, const double& new_price,
-                     std::string& response) const;
-    bool GetOrderBook(const std::string& instrument_name, std::string& response) const;
-    bool GetCurrentPositions(const std::string& currency, const std::string& kind,
-                             std::string& response) const;
-    bool GetOpenOrders(std::string& response) const;
-};
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <drogon/HttpClient.h>
+
+#include "api_credentials.h"
+#include "exchange_types.h"
+#include "token_manager.h"
+
+enum class OrderType
+{
+    LIMIT,
+    MARKET,
+    STOP_LIMIT,
+    STOP_MARKET
+};
+
+enum class InstrumentType
+{
+    SPOT,
+    FUTURES,
+    OPTION
+};
+
+struct OrderParams
+{
+    std::string instrument_name;  // e.g., "BTC-PERPETUAL", "BTC-28JUN24"
+    double amount;                // Amount in base currency
+    double price;                 // Optional for market orders
+    std::string label;            // Client order ID
+    OrderType type;               // Order type
+    std::string time_in_force;    // "good_til_cancelled", "fill_or_kill" "immediate_or_cancel"
+    double trigger_price{0.0};    // Stop orders only; compared against the last trade price
+};
+
+// Completion callbacks receive the decoded response; success is false on transport, HTTP or
+// exchange errors, in which case the struct is left default-initialised.
+using OrderCallback = std::function<void(bool success, const Order& order)>;
+using OrdersCallback = std::function<void(bool success, const std::vector<Order>& orders)>;
+using PositionsCallback = std::function<void(bool success, const std::vector<Position>& positions)>;
+using OrderBookCallback = std::function<void(bool success, const OrderBookSnapshot& book)>;
+using ProbeCallback = std::function<void(bool success)>;
+using CancelAllCallback = std::function<void(bool success, int64_t cancelled)>;
+
+class OrderManager
+{
+  private:
+    static constexpr size_t BUFFER_SIZE = 2048;
+    static constexpr const char* BASE_URL = "https://test.deribit.com";
+    static constexpr const char* API_PATH = "/api/v2/private/";
+    std::shared_ptr<drogon::HttpClient> m_client;
+    TokenManager& m_token_manager;
+    ApiCredentials m_api_credentials;
+    bool m_display_responses{true};
+
+  public:
+    OrderManager(TokenManager& token_manager);
+    // For accounts other than the default one in api_key.txt and api_secret.txt
+    OrderManager(TokenManager& token_manager, const std::string& key_file_path,
+                 const std::string& secret_file_path);
+    bool RefreshTokenIfNeeded() const;
+
+    static std::string GetOrderTypeString(const OrderType& type);
+
+    // Request path formatting, split out so it can be benchmarked without a client. Return the
+    // snprintf result: negative on error or unsupported type, >= size when truncated.
+    static int FormatPlaceOrderPath(char* buffer, size_t size, const OrderParams& params,
+                                    const std::string& side);
+    static int FormatModifyOrderPath(char* buffer, size_t size, const std::string& order_id, double new_amount,
+                                     double new_price);
+
+    // Printing decoded responses to stdout is optional; callers consuming the callbacks can turn it off
+    void SetDisplayResponses(bool display_responses) noexcept;
+
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr) const;
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr) const;
+    bool ModifyOrder(const std::string& order_id, const double& new_amount, const double& new_price,
+                     OrderCallback callback = nullptr) const;
+    bool GetOrderBook(const std::string& instrument_name, OrderBookCallback callback = nullptr) const;
+    bool GetCurrentPositions(const std::string& currency, const std::string& kind,
+                             PositionsCallback callback = nullptr) const;
+    bool GetOpenOrders(OrdersCallback callback = nullptr) const;
+    bool GetOrderState(const std::string& order_id, OrderCallback callback = nullptr) const;
+
+    // private/cancel_all: every open order of the account, on all instruments
+    bool CancelAll(CancelAllCallback callback = nullptr) const;
+
+    // public/test: a cheap, unauthenticated round trip over this manager's connection, used as a
+    // latency and health probe
+    bool Ping(ProbeCallback callback) const;
+};
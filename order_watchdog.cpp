@@ -0,0 +1,280 @@
+#include "order_watchdog.h"
+
+#include <iostream>
+
+OrderWatchdog::OrderWatchdog(const OrderManager& order_manager, const std::chrono::milliseconds tick,
+                             const size_t capacity)
+    : m_order_manager(order_manager), m_tick(tick), m_wheel(tick, capacity)
+{
+    m_entries.reserve(capacity);
+    m_free_entries.reserve(capacity);
+    m_wheel.SetExpiryHandler([this](const uint32_t kind, const uint64_t payload)
+                             { OnTimerExpired(kind, payload); });
+}
+
+OrderWatchdog::~OrderWatchdog()
+{
+    Stop();
+}
+
+void OrderWatchdog::SetAckTimeout(const std::chrono::milliseconds timeout) noexcept
+{
+    m_ack_timeout = timeout;
+}
+
+void OrderWatchdog::SetAckTimeoutHandler(AckTimeoutHandler handler)
+{
+    m_ack_timeout_handler = std::move(handler);
+}
+
+void OrderWatchdog::SetOrderExpiryHandler(OrderExpiryHandler handler)
+{
+    m_expiry_handler = std::move(handler);
+}
+
+void OrderWatchdog::SetStaleQuoteHandler(StaleQuoteHandler handler)
+{
+    m_stale_quote_handler = std::move(handler);
+}
+
+uint32_t OrderWatchdog::AcquireEntry(const std::string& key)
+{
+    uint32_t index;
+    if (!m_free_entries.empty())
+    {
+        index = m_free_entries.back();
+        m_free_entries.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    Entry& entry = m_entries[index];
+    entry.key.assign(key);  // Reuses the pooled string's capacity
+    entry.timer = TimingWheel::INVALID_TIMER;
+    entry.max_age = std::chrono::milliseconds(0);
+    entry.in_use = true;
+    return index;
+}
+
+void OrderWatchdog::ReleaseEntry(const uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    m_wheel.Cancel(entry.timer);
+    entry.timer = TimingWheel::INVALID_TIMER;
+    entry.in_use = false;
+    ++entry.generation;
+    m_free_entries.push_back(index);
+}
+
+uint64_t OrderWatchdog::MakePayload(const uint32_t index) const noexcept
+{
+    return (static_cast<uint64_t>(m_entries[index].generation) << 32) | index;
+}
+
+OrderWatchdog::Entry* OrderWatchdog::Resolve(const uint64_t payload) noexcept
+{
+    const auto index = static_cast<uint32_t>(payload & 0xFFFFFFFFu);
+    if (index >= m_entries.size())
+    {
+        return nullptr;
+    }
+    Entry& entry = m_entries[index];
+    return entry.in_use && entry.generation == static_cast<uint32_t>(payload >> 32) ? &entry : nullptr;
+}
+
+OrderCallback OrderWatchdog::ArmAck(const std::string& request, OrderCallback callback, uint64_t& payload)
+{
+    const uint32_t index = AcquireEntry(request);
+    payload = MakePayload(index);
+    m_entries[index].timer =
+        m_wheel.ScheduleAfter(m_ack_timeout, static_cast<uint32_t>(TimerKind::ACK_TIMEOUT), payload);
+
+    return [this, payload, callback = std::move(callback)](const bool success, const Order& order)
+    {
+        DisarmAck(payload);
+        if (callback)
+        {
+            callback(success, order);
+        }
+    };
+}
+
+void OrderWatchdog::DisarmAck(const uint64_t payload)
+{
+    if (Resolve(payload) != nullptr)
+    {
+        ReleaseEntry(static_cast<uint32_t>(payload & 0xFFFFFFFFu));
+    }
+}
+
+bool OrderWatchdog::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    uint64_t payload;
+    OrderCallback armed =
+        ArmAck(side + " " + params.instrument_name + " " + params.label, std::move(callback), payload);
+    if (!m_order_manager.PlaceOrder(params, side, std::move(armed)))
+    {
+        DisarmAck(payload);
+        return false;
+    }
+    return true;
+}
+
+bool OrderWatchdog::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                                OrderCallback callback)
+{
+    uint64_t payload;
+    OrderCallback armed = ArmAck("edit " + order_id, std::move(callback), payload);
+    if (!m_order_manager.ModifyOrder(order_id, new_amount, new_price, std::move(armed)))
+    {
+        DisarmAck(payload);
+        return false;
+    }
+    return true;
+}
+
+bool OrderWatchdog::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    uint64_t payload;
+    OrderCallback armed = ArmAck("cancel " + order_id, std::move(callback), payload);
+    if (!m_order_manager.CancelOrder(order_id, std::move(armed)))
+    {
+        DisarmAck(payload);
+        return false;
+    }
+    return true;
+}
+
+void OrderWatchdog::ExpireAt(const std::string& order_id, const std::chrono::steady_clock::time_point deadline)
+{
+    const auto existing = m_expiries.find(order_id);
+    const uint32_t index = existing != m_expiries.end() ? existing->second : AcquireEntry(order_id);
+    Entry& entry = m_entries[index];
+    m_wheel.Cancel(entry.timer);
+    entry.timer =
+        m_wheel.ScheduleAt(deadline, static_cast<uint32_t>(TimerKind::ORDER_EXPIRY), MakePayload(index));
+    m_expiries.emplace(order_id, index);
+}
+
+bool OrderWatchdog::ClearExpiry(const std::string& order_id)
+{
+    const auto existing = m_expiries.find(order_id);
+    if (existing == m_expiries.end())
+    {
+        return false;
+    }
+    ReleaseEntry(existing->second);
+    m_expiries.erase(existing);
+    return true;
+}
+
+void OrderWatchdog::WatchQuotes(const std::string& instrument_name, const std::chrono::milliseconds max_age)
+{
+    const auto existing = m_quotes.find(instrument_name);
+    const uint32_t index = existing != m_quotes.end() ? existing->second : AcquireEntry(instrument_name);
+    Entry& entry = m_entries[index];
+    entry.max_age = max_age;
+    m_wheel.Cancel(entry.timer);
+    entry.timer =
+        m_wheel.ScheduleAfter(max_age, static_cast<uint32_t>(TimerKind::QUOTE_STALE), MakePayload(index));
+    m_quotes.emplace(instrument_name, index);
+}
+
+bool OrderWatchdog::UnwatchQuotes(const std::string& instrument_name)
+{
+    const auto existing = m_quotes.find(instrument_name);
+    if (existing == m_quotes.end())
+    {
+        return false;
+    }
+    ReleaseEntry(existing->second);
+    m_quotes.erase(existing);
+    return true;
+}
+
+void OrderWatchdog::OnTicker(const Ticker& ticker)
+{
+    const auto existing = m_quotes.find(ticker.instrument_name);
+    if (existing == m_quotes.end())
+    {
+        return;
+    }
+    // Re-arming is a cancel plus a schedule, both O(1)
+    Entry& entry = m_entries[existing->second];
+    m_wheel.Cancel(entry.timer);
+    entry.timer = m_wheel.ScheduleAfter(entry.max_age, static_cast<uint32_t>(TimerKind::QUOTE_STALE),
+                                        MakePayload(existing->second));
+}
+
+void OrderWatchdog::OnTimerExpired(const uint32_t kind, const uint64_t payload)
+{
+    Entry* entry = Resolve(payload);
+    if (entry == nullptr)
+    {
+        return;
+    }
+    entry->timer = TimingWheel::INVALID_TIMER;
+    const auto index = static_cast<uint32_t>(payload & 0xFFFFFFFFu);
+
+    switch (static_cast<TimerKind>(kind))
+    {
+        case TimerKind::ACK_TIMEOUT:
+        {
+            std::cerr << "No acknowledgement within " << m_ack_timeout.count() << " ms for: " << entry->key
+                      << "\n";
+            const std::string request = entry->key;
+            ReleaseEntry(index);
+            if (m_ack_timeout_handler)
+            {
+                m_ack_timeout_handler(request);
+            }
+            break;
+        }
+        case TimerKind::ORDER_EXPIRY:
+        {
+            const std::string order_id = entry->key;
+            m_expiries.erase(order_id);
+            ReleaseEntry(index);
+            m_order_manager.CancelOrder(order_id);
+            if (m_expiry_handler)
+            {
+                m_expiry_handler(order_id);
+            }
+            break;
+        }
+        case TimerKind::QUOTE_STALE:
+        {
+            // Stays watched; the next ticker re-arms it
+            const std::string instrument_name = entry->key;
+            if (m_stale_quote_handler)
+            {
+                m_stale_quote_handler(instrument_name);
+            }
+            break;
+        }
+    }
+}
+
+void OrderWatchdog::Advance(const std::chrono::steady_clock::time_point now)
+{
+    m_wheel.Advance(now);
+}
+
+void OrderWatchdog::Start(trantor::EventLoop* loop)
+{
+    Stop();
+    m_loop = loop;
+    const double interval_seconds = std::chrono::duration<double>(m_tick).count();
+    m_timer_id = m_loop->runEvery(interval_seconds, [this]() { Advance(std::chrono::steady_clock::now()); });
+}
+
+void OrderWatchdog::Stop()
+{
+    if (m_loop != nullptr)
+    {
+        m_loop->invalidateTimer(m_timer_id);
+        m_loop = nullptr;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <trantor/net/EventLoop.h>
+
+#include "exchange_types.h"
+#include "order_manager.h"
+#include "timing_wheel.h"
+
+using AckTimeoutHandler = std::function<void(const std::string& request)>;
+using OrderExpiryHandler = std::function<void(const std::string& order_id)>;
+using StaleQuoteHandler = std::function<void(const std::string& instrument_name)>;
+
+// Per-order deadlines on top of a TimingWheel driven from the order event loop:
+//  - ack timeouts for requests sent through the wrapped PlaceOrder/ModifyOrder/CancelOrder, which
+//    flag orders whose state is unknown because the exchange never answered;
+//  - good-till-time expiry, cancelling the order on our side when its deadline passes;
+//  - quote staleness, raised when an instrument's ticker has not updated within its max age.
+// Arming and disarming is O(1) and reuses pooled entries, so tens of thousands of live orders
+// cost one wheel advance per tick rather than one timer each.
+class OrderWatchdog
+{
+  private:
+    enum class TimerKind : uint32_t
+    {
+        ACK_TIMEOUT,
+        ORDER_EXPIRY,
+        QUOTE_STALE
+    };
+
+    struct Entry
+    {
+        std::string key;  // Request description, order id or instrument name
+        TimerHandle timer{TimingWheel::INVALID_TIMER};
+        std::chrono::milliseconds max_age{0};
+        uint32_t generation{0};
+        bool in_use{false};
+    };
+
+    const OrderManager& m_order_manager;
+    std::chrono::milliseconds m_tick;
+    TimingWheel m_wheel;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_free_entries;
+    std::unordered_map<std::string, uint32_t> m_expiries;
+    std::unordered_map<std::string, uint32_t> m_quotes;
+    std::chrono::milliseconds m_ack_timeout{2000};
+    AckTimeoutHandler m_ack_timeout_handler;
+    OrderExpiryHandler m_expiry_handler;
+    StaleQuoteHandler m_stale_quote_handler;
+    trantor::EventLoop* m_loop{nullptr};
+    trantor::TimerId m_timer_id{0};
+
+    uint32_t AcquireEntry(const std::string& key);
+    void ReleaseEntry(uint32_t index);
+    uint64_t MakePayload(uint32_t index) const noexcept;
+    Entry* Resolve(uint64_t payload) noexcept;
+
+    OrderCallback ArmAck(const std::string& request, OrderCallback callback, uint64_t& payload);
+    void DisarmAck(uint64_t payload);
+    void OnTimerExpired(uint32_t kind, uint64_t payload);
+
+  public:
+    OrderWatchdog(const OrderManager& order_manager, std::chrono::milliseconds tick, size_t capacity);
+    ~OrderWatchdog();
+
+    void SetAckTimeout(std::chrono::milliseconds timeout) noexcept;
+    void SetAckTimeoutHandler(AckTimeoutHandler handler);
+    void SetOrderExpiryHandler(OrderExpiryHandler handler);
+    void SetStaleQuoteHandler(StaleQuoteHandler handler);
+
+    // Order entry with an ack deadline; the callback still runs if the answer arrives late
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+
+    // Good-till-time: cancels the order once the deadline passes unless cleared first
+    void ExpireAt(const std::string& order_id, std::chrono::steady_clock::time_point deadline);
+    bool ClearExpiry(const std::string& order_id);
+
+    // Raises the stale handler once per episode when no ticker arrives within max_age
+    void WatchQuotes(const std::string& instrument_name, std::chrono::milliseconds max_age);
+    bool UnwatchQuotes(const std::string& instrument_name);
+    void OnTicker(const Ticker& ticker);
+
+    void Advance(std::chrono::steady_clock::time_point now);
+    void Start(trantor::EventLoop* loop);
+    void Stop();
+};
@@ -0,0 +1,446 @@
+#include "quote_engine.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+constexpr double EPSILON = 1e-9;
+constexpr const char* SIDE_NAMES[] = {"buy", "sell"};
+
+bool IsTerminalState(const std::string& order_state)
+{
+    return order_state == "filled" || order_state == "cancelled" || order_state == "rejected";
+}
+
+// Quote labels are "<prefix>-<market>-<slot>-<sequence>"; the prefix may itself contain '-'
+bool ParseQuoteLabel(const std::string& label, const std::string& prefix, uint32_t& market, uint32_t& slot,
+                     uint32_t& sequence)
+{
+    if (label.size() <= prefix.size() || label.compare(0, prefix.size(), prefix) != 0 ||
+        label[prefix.size()] != '-')
+    {
+        return false;
+    }
+    uint32_t* fields[] = {&sequence, &slot, &market};
+    size_t end = label.size();
+    for (uint32_t* field : fields)
+    {
+        const size_t dash = label.rfind('-', end - 1);
+        if (dash == std::string::npos || dash < prefix.size() || dash + 1 >= end)
+        {
+            return false;
+        }
+        char* parse_end = nullptr;
+        const unsigned long value = std::strtoul(label.c_str() + dash + 1, &parse_end, 10);
+        if (parse_end != label.c_str() + end)
+        {
+            return false;
+        }
+        *field = static_cast<uint32_t>(value);
+        end = dash;
+    }
+    return end == prefix.size();
+}
+}  // namespace
+
+QuoteEngine::QuoteEngine(const OrderManager& order_manager, std::string label_prefix)
+    : m_order_manager(order_manager), m_label_prefix(std::move(label_prefix))
+{
+}
+
+void QuoteEngine::SetFillCallback(QuoteFillCallback callback)
+{
+    m_fill_callback = std::move(callback);
+}
+
+const QuoteEngineStats& QuoteEngine::GetStats() const noexcept
+{
+    return m_stats;
+}
+
+// A quote being cancelled no longer counts towards the side
+bool QuoteEngine::IsLive(const QuoteState state) noexcept
+{
+    return state == QuoteState::PENDING_NEW || state == QuoteState::WORKING ||
+           state == QuoteState::PENDING_EDIT;
+}
+
+uint32_t QuoteEngine::GetMarket(const std::string& instrument_name)
+{
+    const auto existing = m_market_index.find(instrument_name);
+    if (existing != m_market_index.end())
+    {
+        return existing->second;
+    }
+    const auto market = static_cast<uint32_t>(m_markets.size());
+    m_markets.emplace_back();
+    m_markets.back().instrument_name = instrument_name;
+    m_market_index.emplace(instrument_name, market);
+    return market;
+}
+
+void QuoteEngine::MarkDirty(const uint32_t market)
+{
+    if (!m_markets[market].dirty)
+    {
+        m_markets[market].dirty = true;
+        m_dirty.push_back(market);
+    }
+}
+
+bool QuoteEngine::IsWithin(const double lhs, const double rhs, const double tolerance) const noexcept
+{
+    return std::fabs(lhs - rhs) <= tolerance + EPSILON;
+}
+
+void QuoteEngine::SetTolerance(const std::string& instrument_name, const QuoteTolerance& tolerance)
+{
+    m_markets[GetMarket(instrument_name)].tolerance = tolerance;
+}
+
+void QuoteEngine::SetQuotes(const std::string& instrument_name, const std::vector<QuoteLevel>& bids,
+                            const std::vector<QuoteLevel>& asks)
+{
+    const uint32_t market = GetMarket(instrument_name);
+    const std::vector<QuoteLevel>* levels[] = {&bids, &asks};
+    for (size_t side = 0; side < SIDE_COUNT; ++side)
+    {
+        QuoteSide& quote_side = m_markets[market].sides[side];
+        quote_side.target_count = 0;
+        for (const QuoteLevel& level : *levels[side])
+        {
+            if (quote_side.target_count == MAX_LAYERS)
+            {
+                break;
+            }
+            if (level.price > 0.0 && level.amount > 0.0)
+            {
+                quote_side.targets[quote_side.target_count++] = level;
+            }
+        }
+    }
+    MarkDirty(market);
+}
+
+void QuoteEngine::CancelQuotes(const std::string& instrument_name)
+{
+    const auto existing = m_market_index.find(instrument_name);
+    if (existing == m_market_index.end())
+    {
+        return;
+    }
+    for (QuoteSide& side : m_markets[existing->second].sides)
+    {
+        side.target_count = 0;
+    }
+    MarkDirty(existing->second);
+}
+
+void QuoteEngine::CancelAllQuotes()
+{
+    for (uint32_t market = 0; market < m_markets.size(); ++market)
+    {
+        for (QuoteSide& side : m_markets[market].sides)
+        {
+            side.target_count = 0;
+        }
+        MarkDirty(market);
+    }
+}
+
+void QuoteEngine::Requote()
+{
+    // Take the list first: a send that fails synchronously marks its market dirty for the next call
+    m_requoting.swap(m_dirty);
+    for (const uint32_t market : m_requoting)
+    {
+        m_markets[market].dirty = false;
+        for (size_t side = 0; side < SIDE_COUNT; ++side)
+        {
+            Diff(market, side, true);
+        }
+    }
+    m_requoting.clear();
+}
+
+void QuoteEngine::Diff(const uint32_t market, const size_t side, const bool is_requote)
+{
+    const QuoteTolerance tolerance = m_markets[market].tolerance;
+    QuoteSide& quote_side = m_markets[market].sides[side];
+    bool target_matched[MAX_LAYERS]{};
+    for (LiveQuote& quote : quote_side.quotes)
+    {
+        quote.matched = false;
+    }
+
+    // Pass 1: live quotes already at a target price, within tolerance. At most the size changes,
+    // and it is edited at the quote's own price so the order keeps its place in the queue.
+    for (size_t target = 0; target < quote_side.target_count; ++target)
+    {
+        const QuoteLevel& level = quote_side.targets[target];
+        size_t best = MAX_LAYERS;
+        double best_distance = 0.0;
+        for (size_t slot = 0; slot < MAX_LAYERS; ++slot)
+        {
+            const LiveQuote& quote = quote_side.quotes[slot];
+            const double distance = std::fabs(quote.price - level.price);
+            const bool candidate = IsLive(quote.state) && !quote.matched &&
+                                   IsWithin(quote.price, level.price, tolerance.price);
+            if (candidate && (best == MAX_LAYERS || distance < best_distance))
+            {
+                best = slot;
+                best_distance = distance;
+            }
+        }
+        if (best == MAX_LAYERS)
+        {
+            continue;
+        }
+
+        LiveQuote& quote = quote_side.quotes[best];
+        quote.matched = true;
+        target_matched[target] = true;
+        if (quote.state != QuoteState::WORKING)
+        {
+            continue;  // Diffed again when its reply arrives
+        }
+        if (IsWithin(quote.amount - quote.filled_amount, level.amount, tolerance.amount))
+        {
+            m_stats.unchanged += is_requote ? 1 : 0;
+        }
+        else
+        {
+            SendEdit(market, side, best, quote.price, level.amount);
+        }
+    }
+
+    // Pass 2: move the remaining live quotes onto the remaining targets, then place what is left
+    for (size_t target = 0; target < quote_side.target_count; ++target)
+    {
+        if (target_matched[target])
+        {
+            continue;
+        }
+        const QuoteLevel& level = quote_side.targets[target];
+        size_t spare = MAX_LAYERS;
+        size_t idle = MAX_LAYERS;
+        for (size_t slot = 0; slot < MAX_LAYERS && spare == MAX_LAYERS; ++slot)
+        {
+            const LiveQuote& quote = quote_side.quotes[slot];
+            if (IsLive(quote.state) && !quote.matched)
+            {
+                spare = slot;
+            }
+            else if (quote.state == QuoteState::IDLE && idle == MAX_LAYERS)
+            {
+                idle = slot;
+            }
+        }
+
+        if (spare != MAX_LAYERS)
+        {
+            quote_side.quotes[spare].matched = true;
+            if (quote_side.quotes[spare].state == QuoteState::WORKING)
+            {
+                SendEdit(market, side, spare, level.price, level.amount);
+            }
+        }
+        else if (idle != MAX_LAYERS)
+        {
+            quote_side.quotes[idle].matched = true;
+            SendNew(market, side, idle, level);
+        }
+        // Otherwise every slot is still being cancelled; the cancel replies diff this side again
+    }
+
+    // Pass 3: pull live quotes no target wants
+    for (size_t slot = 0; slot < MAX_LAYERS; ++slot)
+    {
+        const LiveQuote& quote = quote_side.quotes[slot];
+        if (quote.state == QuoteState::WORKING && !quote.matched)
+        {
+            SendCancel(market, side, slot);
+        }
+    }
+}
+
+void QuoteEngine::SendNew(const uint32_t market, const size_t side, const size_t slot,
+                          const QuoteLevel& target)
+{
+    LiveQuote& quote = m_markets[market].sides[side].quotes[slot];
+    const uint32_t sequence = quote.sequence + 1;
+    quote = LiveQuote{};
+    quote.state = QuoteState::PENDING_NEW;
+    quote.sequence = sequence;
+    quote.price = target.price;
+    quote.amount = target.amount;
+    quote.matched = true;
+
+    char label[64];
+    const int written = snprintf(label, sizeof(label), "%s-%u-%zu-%u", m_label_prefix.c_str(), market,
+                                 side * MAX_LAYERS + slot, quote.sequence);
+    if (written < 0 || written >= static_cast<int>(sizeof(label)))
+    {
+        std::cerr << "Quote label too long for prefix: " << m_label_prefix << "\n";
+        quote.state = QuoteState::IDLE;
+        return;
+    }
+
+    const OrderParams order_params{m_markets[market].instrument_name, target.amount, target.price, label,
+                                   OrderType::LIMIT, "good_til_cancelled"};
+    ++m_stats.new_orders;
+    if (!m_order_manager.PlaceOrder(order_params, SIDE_NAMES[side], MakeCallback(market, side, slot, true)))
+    {
+        quote.state = QuoteState::IDLE;
+        MarkDirty(market);
+    }
+}
+
+// Deribit's edit takes the order's total amount, so what has filled is added back
+void QuoteEngine::SendEdit(const uint32_t market, const size_t side, const size_t slot, const double price,
+                           const double open_amount)
+{
+    LiveQuote& quote = m_markets[market].sides[side].quotes[slot];
+    const double amount = quote.filled_amount + open_amount;
+    quote.state = QuoteState::PENDING_EDIT;
+    ++m_stats.edits;
+    if (!m_order_manager.ModifyOrder(quote.order_id, amount, price, MakeCallback(market, side, slot, true)))
+    {
+        quote.state = QuoteState::WORKING;
+        MarkDirty(market);
+        return;
+    }
+    quote.price = price;
+    quote.amount = amount;
+}
+
+void QuoteEngine::SendCancel(const uint32_t market, const size_t side, const size_t slot)
+{
+    LiveQuote& quote = m_markets[market].sides[side].quotes[slot];
+    quote.state = QuoteState::PENDING_CANCEL;
+    ++m_stats.cancels;
+    if (!m_order_manager.CancelOrder(quote.order_id, MakeCallback(market, side, slot, true)))
+    {
+        quote.state = QuoteState::WORKING;
+        MarkDirty(market);
+    }
+}
+
+void QuoteEngine::RequestStatus(const uint32_t market, const size_t side, const size_t slot)
+{
+    const LiveQuote& quote = m_markets[market].sides[side].quotes[slot];
+    m_order_manager.GetOrderState(quote.order_id, MakeCallback(market, side, slot, false));
+}
+
+OrderCallback QuoteEngine::MakeCallback(const uint32_t market, const size_t side, const size_t slot,
+                                        const bool is_ack)
+{
+    const uint32_t sequence = m_markets[market].sides[side].quotes[slot].sequence;
+    return [this, market, side, slot, sequence, is_ack](const bool success, const Order& order)
+    { OnResponse(market, side, slot, sequence, is_ack, success, order); };
+}
+
+void QuoteEngine::OnResponse(const uint32_t market, const size_t side, const size_t slot,
+                             const uint32_t sequence, const bool is_ack, const bool success,
+                             const Order& order)
+{
+    LiveQuote& quote = m_markets[market].sides[side].quotes[slot];
+    if (quote.sequence != sequence || quote.state == QuoteState::IDLE)
+    {
+        return;  // Reply for a quote that has since been replaced
+    }
+
+    if (!success)
+    {
+        if (!is_ack)
+        {
+            return;
+        }
+        // A failed new order leaves nothing on the book. A failed edit or cancel usually means the
+        // order filled or went away, so ask for its state. Either way retry on the next Requote
+        // rather than now, so a persistent reject cannot loop at network speed.
+        if (quote.state == QuoteState::PENDING_NEW)
+        {
+            quote.state = QuoteState::IDLE;
+        }
+        else
+        {
+            quote.state = QuoteState::WORKING;
+            RequestStatus(market, side, slot);
+        }
+        MarkDirty(market);
+        return;
+    }
+
+    ApplyOrder(quote, order, is_ack);
+    if (is_ack)
+    {
+        Diff(market, side, false);
+    }
+    else
+    {
+        MarkDirty(market);
+    }
+}
+
+void QuoteEngine::ApplyOrder(LiveQuote& quote, const Order& order, const bool is_ack)
+{
+    if (!order.order_id.empty())
+    {
+        std::snprintf(quote.order_id, ORDER_ID_SIZE, "%s", order.order_id.c_str());
+    }
+
+    const double filled_delta = order.filled_amount - quote.filled_amount;
+    if (filled_delta > EPSILON)
+    {
+        quote.filled_amount = order.filled_amount;
+    }
+    if (order.amount > 0.0)
+    {
+        quote.amount = order.amount;
+    }
+    if (order.price > 0.0)
+    {
+        quote.price = order.price;
+    }
+
+    if (IsTerminalState(order.order_state))
+    {
+        quote.state = QuoteState::IDLE;
+    }
+    else if (is_ack)
+    {
+        quote.state = QuoteState::WORKING;
+    }
+
+    if (filled_delta > EPSILON && m_fill_callback)
+    {
+        m_fill_callback(order, filled_delta);
+    }
+}
+
+void QuoteEngine::OnOrderUpdate(const Order& order)
+{
+    uint32_t market;
+    uint32_t slot;
+    uint32_t sequence;
+    if (!ParseQuoteLabel(order.label, m_label_prefix, market, slot, sequence) || market >= m_markets.size() ||
+        slot >= SIDE_COUNT * MAX_LAYERS)
+    {
+        return;
+    }
+    LiveQuote& quote = m_markets[market].sides[slot / MAX_LAYERS].quotes[slot % MAX_LAYERS];
+    if (quote.sequence != sequence || quote.state == QuoteState::IDLE)
+    {
+        return;
+    }
+    ApplyOrder(quote, order, false);
+    if (quote.state == QuoteState::IDLE)
+    {
+        MarkDirty(market);  // Filled or cancelled away; replaced on the next Requote
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exchange_types.h"
+#include "order_manager.h"
+
+struct QuoteLevel
+{
+    double price{0.0};
+    double amount{0.0};  // Size to show; the engine adds what has already filled when editing
+};
+
+// Changes no larger than these leave a live quote alone
+struct QuoteTolerance
+{
+    double price{0.0};
+    double amount{0.0};
+};
+
+// Message counts since construction; unchanged counts live quotes a Requote left alone
+struct QuoteEngineStats
+{
+    uint64_t new_orders{0};
+    uint64_t edits{0};
+    uint64_t cancels{0};
+    uint64_t unchanged{0};
+};
+
+using QuoteFillCallback = std::function<void(const Order& order, double filled_delta)>;
+
+// Maintains two-sided, layered quotes per instrument. The strategy declares the quotes it wants
+// with SetQuotes for any number of instruments, then calls Requote once per tick; the engine diffs
+// each changed instrument against its live orders and sends the fewest messages that converge:
+//  - a live quote within tolerance of a target is kept, or edited in size only at its own price,
+//    so it keeps queue priority;
+//  - other live quotes are edited onto the remaining targets rather than cancelled and replaced;
+//  - only then are new orders placed for targets left over, or cancels sent for live quotes left over.
+// A quote with a request in flight is not touched; its side is diffed again when the reply arrives.
+//
+// Quotes are pooled per instrument and labelled "<prefix>-<market>-<slot>-<sequence>", so
+// OnOrderUpdate can route private order updates without a lookup table. All methods must be
+// called on drogon's main loop, where the OrderManager callbacks run.
+class QuoteEngine
+{
+  public:
+    static constexpr size_t MAX_LAYERS = 8;
+
+  private:
+    static constexpr size_t ORDER_ID_SIZE = 48;
+    static constexpr size_t SIDE_COUNT = 2;  // 0 bids, 1 asks
+
+    enum class QuoteState : uint8_t
+    {
+        IDLE,
+        PENDING_NEW,
+        WORKING,
+        PENDING_EDIT,
+        PENDING_CANCEL
+    };
+
+    struct LiveQuote
+    {
+        QuoteState state{QuoteState::IDLE};
+        char order_id[ORDER_ID_SIZE]{};
+        uint32_t sequence{0};
+        double price{0.0};  // Requested price while an edit or new order is pending
+        double amount{0.0};  // Total order amount, filled part included
+        double filled_amount{0.0};
+        bool matched{false};  // Scratch for Diff
+    };
+
+    struct QuoteSide
+    {
+        QuoteLevel targets[MAX_LAYERS];
+        size_t target_count{0};
+        LiveQuote quotes[MAX_LAYERS];
+    };
+
+    struct Market
+    {
+        std::string instrument_name;
+        QuoteTolerance tolerance;
+        QuoteSide sides[SIDE_COUNT];
+        bool dirty{false};
+    };
+
+    const OrderManager& m_order_manager;
+    std::string m_label_prefix;
+    std::vector<Market> m_markets;
+    std::unordered_map<std::string, uint32_t> m_market_index;
+    std::vector<uint32_t> m_dirty;
+    std::vector<uint32_t> m_requoting;
+    QuoteEngineStats m_stats;
+    QuoteFillCallback m_fill_callback;
+
+    uint32_t GetMarket(const std::string& instrument_name);
+    void MarkDirty(uint32_t market);
+    static bool IsLive(QuoteState state) noexcept;
+    bool IsWithin(double lhs, double rhs, double tolerance) const noexcept;
+
+    void Diff(uint32_t market, size_t side, bool is_requote);
+    void SendNew(uint32_t market, size_t side, size_t slot, const QuoteLevel& target);
+    void SendEdit(uint32_t market, size_t side, size_t slot, double price, double open_amount);
+    void SendCancel(uint32_t market, size_t side, size_t slot);
+    void RequestStatus(uint32_t market, size_t side, size_t slot);
+    OrderCallback MakeCallback(uint32_t market, size_t side, size_t slot, bool is_ack);
+    void OnResponse(uint32_t market, size_t side, size_t slot, uint32_t sequence, bool is_ack, bool success,
+                    const Order& order);
+    void ApplyOrder(LiveQuote& quote, const Order& order, bool is_ack);
+
+  public:
+    // The label prefix tells this engine's orders apart from other components' on the same account
+    QuoteEngine(const OrderManager& order_manager, std::string label_prefix);
+
+    void SetFillCallback(QuoteFillCallback callback);
+
+    // Defaults to zero, so any change is sent
+    void SetTolerance(const std::string& instrument_name, const QuoteTolerance& tolerance);
+
+    // Replaces the target quotes for one instrument, best layer first; levels past MAX_LAYERS are
+    // ignored and an empty side pulls that side. Nothing is sent until Requote.
+    void SetQuotes(const std::string& instrument_name, const std::vector<QuoteLevel>& bids,
+                   const std::vector<QuoteLevel>& asks);
+    void CancelQuotes(const std::string& instrument_name);
+    void CancelAllQuotes();
+
+    // Diffs every instrument whose targets changed since the last call and sends the updates
+    void Requote();
+
+    void OnOrderUpdate(const Order& order);
+
+    const QuoteEngineStats& GetStats() const noexcept;
+};
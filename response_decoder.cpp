@@ -0,0 +1,490 @@
+#include "response_decoder.h"
+
+#include <iostream>
+#include <tuple>
+
+#include "json_scanner.h"
+
+namespace
+{
+struct RpcError
+{
+    std::string message;
+    int64_t code{0};
+};
+
+// Compile-time mapping from a JSON key to a struct member
+template <typename T, typename M>
+struct FieldDescriptor
+{
+    std::string_view name;
+    M T::*member;
+};
+
+template <typename T, typename M>
+constexpr FieldDescriptor<T, M> Field(const std::string_view name, M T::*member)
+{
+    return {name, member};
+}
+
+template <typename T>
+struct FieldTable;
+
+template <>
+struct FieldTable<Order>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("order_id", &Order::order_id), Field("instrument_name", &Order::instrument_name),
+        Field("order_type", &Order::order_type), Field("order_state", &Order::order_state),
+        Field("direction", &Order::direction), Field("time_in_force", &Order::time_in_force),
+        Field("label", &Order::label), Field("amount", &Order::amount),
+        Field("filled_amount", &Order::filled_amount), Field("price", &Order::price),
+        Field("average_price", &Order::average_price), Field("creation_timestamp", &Order::creation_timestamp),
+        Field("last_update_timestamp", &Order::last_update_timestamp));
+};
+
+template <>
+struct FieldTable<Position>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("instrument_name", &Position::instrument_name), Field("direction", &Position::direction),
+        Field("kind", &Position::kind), Field("size", &Position::size), Field("mark_price", &Position::mark_price),
+        Field("average_price", &Position::average_price),
+        Field("floating_profit_loss", &Position::floating_profit_loss),
+        Field("total_profit_loss", &Position::total_profit_loss), Field("leverage", &Position::leverage),
+        Field("maintenance_margin", &Position::maintenance_margin),
+        Field("initial_margin", &Position::initial_margin),
+        Field("open_orders_margin", &Position::open_orders_margin),
+        Field("creation_timestamp", &Position::creation_timestamp));
+};
+
+template <>
+struct FieldTable<OrderBookSnapshot>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("instrument_name", &OrderBookSnapshot::instrument_name),
+        Field("best_bid_price", &OrderBookSnapshot::best_bid_price),
+        Field("best_bid_amount", &OrderBookSnapshot::best_bid_amount),
+        Field("best_ask_price", &OrderBookSnapshot::best_ask_price),
+        Field("best_ask_amount", &OrderBookSnapshot::best_ask_amount),
+        Field("mark_price", &OrderBookSnapshot::mark_price), Field("index_price", &OrderBookSnapshot::index_price),
+        Field("timestamp", &OrderBookSnapshot::timestamp), Field("change_id", &OrderBookSnapshot::change_id),
+        Field("bids", &OrderBookSnapshot::bids), Field("asks", &OrderBookSnapshot::asks));
+};
+
+template <>
+struct FieldTable<Ticker>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("instrument_name", &Ticker::instrument_name), Field("best_bid_price", &Ticker::best_bid_price),
+        Field("best_bid_amount", &Ticker::best_bid_amount), Field("best_ask_price", &Ticker::best_ask_price),
+        Field("best_ask_amount", &Ticker::best_ask_amount), Field("last_price", &Ticker::last_price),
+        Field("mark_price", &Ticker::mark_price), Field("index_price", &Ticker::index_price),
+        Field("open_interest", &Ticker::open_interest), Field("current_funding", &Ticker::current_funding),
+        Field("funding_8h", &Ticker::funding_8h), Field("timestamp", &Ticker::timestamp));
+};
+
+template <>
+struct FieldTable<Trade>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("trade_id", &Trade::trade_id), Field("instrument_name", &Trade::instrument_name),
+        Field("direction", &Trade::direction), Field("price", &Trade::price), Field("amount", &Trade::amount),
+        Field("mark_price", &Trade::mark_price), Field("index_price", &Trade::index_price),
+        Field("trade_seq", &Trade::trade_seq), Field("timestamp", &Trade::timestamp));
+};
+
+template <>
+struct FieldTable<AuthResult>
+{
+    static constexpr auto FIELDS = std::make_tuple(
+        Field("access_token", &AuthResult::access_token), Field("refresh_token", &AuthResult::refresh_token),
+        Field("token_type", &AuthResult::token_type), Field("scope", &AuthResult::scope),
+        Field("expires_in", &AuthResult::expires_in));
+};
+
+template <>
+struct FieldTable<RpcError>
+{
+    static constexpr auto FIELDS =
+        std::make_tuple(Field("message", &RpcError::message), Field("code", &RpcError::code));
+};
+
+bool ReadValue(JsonScanner& scanner, std::string& out)
+{
+    return scanner.ReadString(out);
+}
+
+bool ReadValue(JsonScanner& scanner, double& out)
+{
+    return scanner.ReadDouble(out);
+}
+
+bool ReadValue(JsonScanner& scanner, int64_t& out)
+{
+    return scanner.ReadInt64(out);
+}
+
+// Book levels arrive as [price, amount] pairs
+bool ReadValue(JsonScanner& scanner, std::vector<PriceLevel>& levels)
+{
+    levels.clear();
+    if (scanner.PeekType() != JsonTokenType::ARRAY)
+    {
+        return scanner.SkipValue();
+    }
+    scanner.BeginArray();
+    while (scanner.NextElement())
+    {
+        PriceLevel level;
+        if (!scanner.BeginArray())
+        {
+            return false;
+        }
+        for (int index = 0; scanner.NextElement(); ++index)
+        {
+            const bool ok = index == 0   ? scanner.ReadDouble(level.price)
+                            : index == 1 ? scanner.ReadDouble(level.amount)
+                                         : scanner.SkipValue();
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        levels.push_back(level);
+    }
+    return scanner.IsGood();
+}
+
+// Clearing rather than reassigning keeps the members' storage for the next decode into the object
+void ResetValue(std::string& value) noexcept
+{
+    value.clear();
+}
+
+void ResetValue(double& value) noexcept
+{
+    value = 0.0;
+}
+
+void ResetValue(int64_t& value) noexcept
+{
+    value = 0;
+}
+
+void ResetValue(std::vector<PriceLevel>& levels) noexcept
+{
+    levels.clear();
+}
+
+template <typename T>
+void ResetObject(T& out) noexcept
+{
+    std::apply([&out](const auto&... field) { (ResetValue(out.*(field.member)), ...); }, FieldTable<T>::FIELDS);
+}
+
+// Looks the key up in the type's field table and reads the value into the matching member.
+// Unknown keys are skipped without being decoded.
+template <typename T>
+bool DecodeMember(JsonScanner& scanner, const std::string_view key, T& out)
+{
+    bool matched = false;
+    bool ok = true;
+    const auto try_field = [&](const auto& field)
+    {
+        if (matched || field.name != key)
+        {
+            return;
+        }
+        matched = true;
+        ok = ReadValue(scanner, out.*(field.member));
+    };
+    std::apply([&](const auto&... field) { (try_field(field), ...); }, FieldTable<T>::FIELDS);
+    return matched ? ok : scanner.SkipValue();
+}
+
+template <typename T>
+bool DecodeObject(JsonScanner& scanner, T& out)
+{
+    if (scanner.PeekType() != JsonTokenType::OBJECT)
+    {
+        return false;
+    }
+    ResetObject(out);
+    scanner.BeginObject();
+    std::string_view key;
+    while (scanner.NextKey(key))
+    {
+        if (!DecodeMember(scanner, key, out))
+        {
+            return false;
+        }
+    }
+    return scanner.IsGood();
+}
+
+// Decodes over the elements already in out, so a vector reused across messages of similar size
+// does not reallocate their strings
+template <typename T>
+bool DecodeArray(JsonScanner& scanner, std::vector<T>& out)
+{
+    size_t count = 0;
+    bool ok = scanner.PeekType() == JsonTokenType::ARRAY;
+    if (ok)
+    {
+        scanner.BeginArray();
+        while (ok && scanner.NextElement())
+        {
+            if (count == out.size())
+            {
+                out.emplace_back();
+            }
+            ok = DecodeObject(scanner, out[count++]);
+        }
+    }
+    out.resize(count);
+    return ok && scanner.IsGood();
+}
+
+// Walks the JSON-RPC envelope once, handing the "result" value to read_result and reporting
+// "error" objects the same way UtilityManager::IsParseJsonGood does.
+template <typename ResultReader>
+bool DecodeEnvelope(const std::string_view response, ResultReader&& read_result)
+{
+    JsonScanner scanner(response);
+    bool has_result = false;
+    bool result_ok = true;
+    bool has_error = false;
+    RpcError error;
+
+    if (scanner.BeginObject())
+    {
+        std::string_view key;
+        while (scanner.NextKey(key))
+        {
+            if (key == "result")
+            {
+                has_result = true;
+                result_ok = read_result(scanner);
+                if (!result_ok)
+                {
+                    break;
+                }
+            }
+            else if (key == "error")
+            {
+                has_error = true;
+                DecodeObject(scanner, error);
+            }
+            else
+            {
+                scanner.SkipValue();
+            }
+        }
+    }
+
+    if (!scanner.IsGood())
+    {
+        std::cerr << "Failed to parse JSON response.\n";
+        return false;
+    }
+    if (has_error)
+    {
+        std::cerr << "Error: " << error.message << ", "
+                  << "Code: " << error.code << "\n";
+        return false;
+    }
+    if (!has_result || !result_ok)
+    {
+        std::cerr << "Unexpected JSON structure in result.\n";
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+bool ResponseDecoder::DecodeOrder(const std::string_view response, Order& order)
+{
+    return DecodeEnvelope(response,
+                          [&order](JsonScanner& scanner)
+                          {
+                              if (scanner.PeekType() != JsonTokenType::OBJECT)
+                              {
+                                  return false;
+                              }
+                              // The order is either nested under "order" or is the result itself
+                              scanner.BeginObject();
+                              std::string_view key;
+                              while (scanner.NextKey(key))
+                              {
+                                  const bool ok = key == "order" ? DecodeObject(scanner, order)
+                                                                 : DecodeMember(scanner, key, order);
+                                  if (!ok)
+                                  {
+                                      return false;
+                                  }
+                              }
+                              return scanner.IsGood();
+                          });
+}
+
+bool ResponseDecoder::DecodeOrders(const std::string_view response, std::vector<Order>& orders)
+{
+    return DecodeEnvelope(response, [&orders](JsonScanner& scanner) { return DecodeArray(scanner, orders); });
+}
+
+bool ResponseDecoder::DecodePositions(const std::string_view response, std::vector<Position>& positions)
+{
+    return DecodeEnvelope(response,
+                          [&positions](JsonScanner& scanner) { return DecodeArray(scanner, positions); });
+}
+
+bool ResponseDecoder::DecodeOrderBook(const std::string_view response, OrderBookSnapshot& book)
+{
+    return DecodeEnvelope(response, [&book](JsonScanner& scanner) { return DecodeObject(scanner, book); });
+}
+
+bool ResponseDecoder::DecodeAuthResult(const std::string_view response, AuthResult& auth)
+{
+    return DecodeEnvelope(response, [&auth](JsonScanner& scanner) { return DecodeObject(scanner, auth); });
+}
+
+bool ResponseDecoder::DecodeCancelAll(const std::string_view response, int64_t& cancelled)
+{
+    cancelled = 0;
+    return DecodeEnvelope(response, [&cancelled](JsonScanner& scanner) { return scanner.ReadInt64(cancelled); });
+}
+
+bool ResponseDecoder::DecodeAck(const std::string_view response)
+{
+    return DecodeEnvelope(response, [](JsonScanner& scanner) { return scanner.SkipValue(); });
+}
+
+bool ResponseDecoder::DecodeSubscription(const std::string_view message, std::string_view& channel,
+                                         std::string_view& data)
+{
+    channel = std::string_view();
+    data = std::string_view();
+
+    // {"jsonrpc": "2.0", "method": "subscription", "params": {"channel": "...", "data": ...}}
+    JsonScanner scanner(message);
+    if (!scanner.BeginObject())
+    {
+        return false;
+    }
+    std::string_view key;
+    while (scanner.NextKey(key))
+    {
+        if (key != "params" || scanner.PeekType() != JsonTokenType::OBJECT)
+        {
+            scanner.SkipValue();
+            continue;
+        }
+        scanner.BeginObject();
+        while (scanner.NextKey(key))
+        {
+            if (key == "channel" && scanner.PeekType() == JsonTokenType::STRING)
+            {
+                scanner.CaptureValue(channel);
+                channel = channel.substr(1, channel.size() - 2);  // Strip the quotes
+            }
+            else if (key == "data")
+            {
+                scanner.CaptureValue(data);
+            }
+            else
+            {
+                scanner.SkipValue();
+            }
+        }
+    }
+    return scanner.IsGood() && !channel.empty() && !data.empty();
+}
+
+bool ResponseDecoder::DecodeTicker(const std::string_view data, Ticker& ticker)
+{
+    JsonScanner scanner(data);
+    return DecodeObject(scanner, ticker);
+}
+
+bool ResponseDecoder::DecodeTrades(const std::string_view data, std::vector<Trade>& trades)
+{
+    JsonScanner scanner(data);
+    return DecodeArray(scanner, trades);
+}
+
+bool ResponseDecoder::DecodeOrderUpdate(const std::string_view data, Order& order)
+{
+    JsonScanner scanner(data);
+    return DecodeObject(scanner, order);
+}
+
+bool ResponseDecoder::DecodeResponseId(const std::string_view message, uint64_t& id)
+{
+    JsonScanner scanner(message);
+    if (!scanner.BeginObject())
+    {
+        return false;
+    }
+    std::string_view key;
+    while (scanner.NextKey(key))
+    {
+        if (key != "id" || scanner.PeekType() != JsonTokenType::NUMBER)
+        {
+            scanner.SkipValue();
+            continue;
+        }
+        int64_t value = 0;
+        if (!scanner.ReadInt64(value) || value < 0)
+        {
+            return false;
+        }
+        id = static_cast<uint64_t>(value);
+        return true;
+    }
+    return false;
+}
+
+bool ResponseDecoder::DecodeHeartbeat(const std::string_view message, bool& test_request)
+{
+    test_request = false;
+
+    // {"jsonrpc": "2.0", "method": "heartbeat", "params": {"type": "test_request"}}
+    JsonScanner scanner(message);
+    if (!scanner.BeginObject())
+    {
+        return false;
+    }
+    bool is_heartbeat = false;
+    std::string_view key;
+    std::string_view value;
+    while (scanner.NextKey(key))
+    {
+        if (key == "method" && scanner.PeekType() == JsonTokenType::STRING)
+        {
+            scanner.CaptureValue(value);
+            is_heartbeat = value == "\"heartbeat\"";
+        }
+        else if (key == "params" && scanner.PeekType() == JsonTokenType::OBJECT)
+        {
+            scanner.BeginObject();
+            while (scanner.NextKey(key))
+            {
+                if (key == "type" && scanner.PeekType() == JsonTokenType::STRING)
+                {
+                    scanner.CaptureValue(value);
+                    test_request = value == "\"test_request\"";
+                }
+                else
+                {
+                    scanner.SkipValue();
+                }
+            }
+        }
+        else
+        {
+            scanner.SkipValue();
+        }
+    }
+    return scanner.IsGood() && is_heartbeat;
+}
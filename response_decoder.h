@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "exchange_types.h"
+
+// Decodes Deribit JSON-RPC responses straight into the typed structs in a single pass over the
+// buffer. Each function returns false (and logs) on malformed JSON or an exchange error.
+class ResponseDecoder
+{
+  public:
+    // private/buy, private/sell and private/edit ({"order": {...}}) as well as private/cancel,
+    // whose result is the order itself
+    static bool DecodeOrder(std::string_view response, Order& order);
+
+    static bool DecodeOrders(std::string_view response, std::vector<Order>& orders);
+    static bool DecodePositions(std::string_view response, std::vector<Position>& positions);
+    static bool DecodeOrderBook(std::string_view response, OrderBookSnapshot& book);
+    static bool DecodeAuthResult(std::string_view response, AuthResult& auth);
+
+    // private/cancel_all, whose result is the number of orders cancelled
+    static bool DecodeCancelAll(std::string_view response, int64_t& cancelled);
+    // Calls whose result carries nothing beyond success, e.g. "ok"
+    static bool DecodeAck(std::string_view response);
+
+    // WebSocket subscription notifications. DecodeSubscription splits the message into its channel
+    // and raw "data" value without logging, since acks and heartbeats are not notifications; the
+    // data is then decoded according to the channel.
+    static bool DecodeSubscription(std::string_view message, std::string_view& channel, std::string_view& data);
+    static bool DecodeTicker(std::string_view data, Ticker& ticker);
+    static bool DecodeTrades(std::string_view data, std::vector<Trade>& trades);
+    static bool DecodeOrderUpdate(std::string_view data, Order& order);  // user.orders.*.raw
+
+    // The id of a JSON-RPC reply received over a WebSocket, so it can be matched to its request.
+    // False without logging for notifications and other messages that carry no numeric id.
+    static bool DecodeResponseId(std::string_view message, uint64_t& id);
+
+    // Heartbeat notifications sent after public/set_heartbeat. test_request is set when the
+    // exchange expects a public/test in reply. False without logging for any other message.
+    static bool DecodeHeartbeat(std::string_view message, bool& test_request);
+};
@@ -0,0 +1,382 @@
+#include "session_manager.h"
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+// Shared by the per-session callbacks of one fan-out request. Starts one above the number of
+// sessions so the result cannot be delivered before every request has been issued.
+template <typename Result, typename Callback>
+struct FanOut
+{
+    size_t remaining;
+    bool success{true};
+    Result result;
+    Callback callback;
+};
+
+void MergePosition(Position& total, const Position& position)
+{
+    const double previous_size = total.size;
+    total.size += position.size;
+    total.floating_profit_loss += position.floating_profit_loss;
+    total.total_profit_loss += position.total_profit_loss;
+    total.maintenance_margin += position.maintenance_margin;
+    total.initial_margin += position.initial_margin;
+    total.open_orders_margin += position.open_orders_margin;
+    total.mark_price = position.mark_price;
+    total.leverage = 0.0;  // Set per account; has no meaning once accounts are netted
+
+    // Average entry of the legs on the side the net position ends up on
+    const bool same_side = (previous_size >= 0.0) == (position.size >= 0.0);
+    if (same_side && total.size != 0.0)
+    {
+        total.average_price = (total.average_price * std::fabs(previous_size) +
+                               position.average_price * std::fabs(position.size)) /
+                              std::fabs(total.size);
+    }
+    else if (std::fabs(position.size) > std::fabs(previous_size))
+    {
+        total.average_price = position.average_price;
+    }
+    if (position.creation_timestamp != 0 &&
+        (total.creation_timestamp == 0 || position.creation_timestamp < total.creation_timestamp))
+    {
+        total.creation_timestamp = position.creation_timestamp;
+    }
+    total.direction = total.size > 0.0 ? "buy" : total.size < 0.0 ? "sell" : "zero";
+}
+}  // namespace
+
+SessionId SessionManager::AddSession(const SessionConfig& config)
+{
+    if (FindSession(config.name) != INVALID_SESSION)
+    {
+        std::cerr << "Session already exists: " << config.name << "\n";
+        return INVALID_SESSION;
+    }
+
+    Session session;
+    session.name = config.name;
+    try
+    {
+        session.token_manager = std::make_unique<TokenManager>(config.access_token_file,
+                                                               config.refresh_token_file, config.expires_in);
+        session.order_manager = std::make_unique<OrderManager>(*session.token_manager, config.api_key_file,
+                                                               config.api_secret_file);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to open session " << config.name << ": " << e.what() << "\n";
+        return INVALID_SESSION;
+    }
+
+    m_sessions.push_back(std::move(session));
+    return static_cast<SessionId>(m_sessions.size() - 1);
+}
+
+size_t SessionManager::GetSessionCount() const noexcept
+{
+    return m_sessions.size();
+}
+
+SessionId SessionManager::FindSession(const std::string& name) const
+{
+    for (size_t index = 0; index < m_sessions.size(); ++index)
+    {
+        if (m_sessions[index].name == name)
+        {
+            return static_cast<SessionId>(index);
+        }
+    }
+    return INVALID_SESSION;
+}
+
+const std::string& SessionManager::GetSessionName(const SessionId session) const
+{
+    return m_sessions.at(session).name;
+}
+
+uint64_t SessionManager::GetRequestCount(const SessionId session) const
+{
+    return m_sessions.at(session).request_count;
+}
+
+const OrderManager& SessionManager::GetOrderManager(const SessionId session) const
+{
+    return *m_sessions.at(session).order_manager;
+}
+
+bool SessionManager::RouteStrategy(const std::string& strategy, const SessionId session)
+{
+    if (session >= m_sessions.size())
+    {
+        std::cerr << "Cannot route strategy " << strategy << " to unknown session\n";
+        return false;
+    }
+    for (auto& route : m_strategy_routes)
+    {
+        if (route.first == strategy)
+        {
+            route.second = session;
+            return true;
+        }
+    }
+    m_strategy_routes.emplace_back(strategy, session);
+    return true;
+}
+
+bool SessionManager::RouteInstrument(const std::string& instrument_name, const SessionId session)
+{
+    if (session >= m_sessions.size())
+    {
+        std::cerr << "Cannot route instrument " << instrument_name << " to unknown session\n";
+        return false;
+    }
+    m_instrument_routes[instrument_name] = session;
+    return true;
+}
+
+void SessionManager::SetDisplayResponses(const bool display_responses) noexcept
+{
+    for (Session& session : m_sessions)
+    {
+        session.order_manager->SetDisplayResponses(display_responses);
+    }
+}
+
+// A strategy owns its own label and every label that extends it with '-'
+bool SessionManager::MatchesStrategy(const std::string& label, const std::string& strategy) noexcept
+{
+    return label.compare(0, strategy.size(), strategy) == 0 &&
+           (label.size() == strategy.size() || label[strategy.size()] == '-');
+}
+
+SessionId SessionManager::Route(const OrderParams& params)
+{
+    for (const auto& route : m_strategy_routes)
+    {
+        if (MatchesStrategy(params.label, route.first))
+        {
+            return route.second;
+        }
+    }
+    const auto instrument = m_instrument_routes.find(params.instrument_name);
+    if (instrument != m_instrument_routes.end())
+    {
+        return instrument->second;
+    }
+
+    // Unrouted flow is spread evenly so each account's rate limit takes its share
+    const SessionId session = m_next_session;
+    m_next_session = (m_next_session + 1) % static_cast<SessionId>(m_sessions.size());
+    return session;
+}
+
+SessionId SessionManager::FindOrderSession(const std::string& order_id) const
+{
+    const auto order = m_order_sessions.find(order_id);
+    return order != m_order_sessions.end() ? order->second.session : INVALID_SESSION;
+}
+
+// Remembers live orders only, so the map stays the size of the open order set
+void SessionManager::TrackOrder(const SessionId session, const Order& order)
+{
+    if (order.order_id.empty())
+    {
+        return;
+    }
+    if (order.order_state == "open" || order.order_state == "untriggered")
+    {
+        m_order_sessions[order.order_id] = {session, ++m_track_sequence};
+    }
+    else
+    {
+        m_order_sessions.erase(order.order_id);
+    }
+}
+
+OrderCallback SessionManager::MakeTrackingCallback(const SessionId session, OrderCallback callback)
+{
+    return [this, session, callback = std::move(callback)](const bool success, const Order& order)
+    {
+        if (success)
+        {
+            TrackOrder(session, order);
+        }
+        if (callback)
+        {
+            callback(success, order);
+        }
+    };
+}
+
+bool SessionManager::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    if (m_sessions.empty())
+    {
+        std::cerr << "No sessions to place order on\n";
+        return false;
+    }
+    const SessionId session = Route(params);
+    ++m_sessions[session].request_count;
+    return m_sessions[session].order_manager->PlaceOrder(params, side,
+                                                         MakeTrackingCallback(session, std::move(callback)));
+}
+
+bool SessionManager::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    const SessionId session = FindOrderSession(order_id);
+    if (session == INVALID_SESSION)
+    {
+        std::cerr << "No session owns order " << order_id << "\n";
+        return false;
+    }
+    ++m_sessions[session].request_count;
+    return m_sessions[session].order_manager->CancelOrder(order_id,
+                                                          MakeTrackingCallback(session, std::move(callback)));
+}
+
+bool SessionManager::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                                 OrderCallback callback)
+{
+    const SessionId session = FindOrderSession(order_id);
+    if (session == INVALID_SESSION)
+    {
+        std::cerr << "No session owns order " << order_id << "\n";
+        return false;
+    }
+    ++m_sessions[session].request_count;
+    return m_sessions[session].order_manager->ModifyOrder(order_id, new_amount, new_price,
+                                                          MakeTrackingCallback(session, std::move(callback)));
+}
+
+bool SessionManager::GetOrderState(const std::string& order_id, OrderCallback callback)
+{
+    const SessionId session = FindOrderSession(order_id);
+    if (session == INVALID_SESSION)
+    {
+        std::cerr << "No session owns order " << order_id << "\n";
+        return false;
+    }
+    ++m_sessions[session].request_count;
+    return m_sessions[session].order_manager->GetOrderState(
+        order_id, MakeTrackingCallback(session, std::move(callback)));
+}
+
+bool SessionManager::GetOpenOrders(OrdersCallback callback)
+{
+    using State = FanOut<std::vector<Order>, OrdersCallback>;
+    const auto state = std::make_shared<State>(State{m_sessions.size() + 1, true, {}, std::move(callback)});
+    const auto finish = [state]()
+    {
+        if (--state->remaining == 0 && state->callback)
+        {
+            state->callback(state->success, state->result);
+        }
+    };
+
+    // Orders tracked up to here that the reply leaves out have closed; later ones may have been
+    // acked after the exchange took its snapshot, so they stay
+    const uint64_t requested_at = m_track_sequence;
+    size_t sent = 0;
+    for (size_t index = 0; index < m_sessions.size(); ++index)
+    {
+        const auto session = static_cast<SessionId>(index);
+        ++m_sessions[index].request_count;
+        const bool requested = m_sessions[index].order_manager->GetOpenOrders(
+            [this, session, requested_at, state, finish](const bool success, const std::vector<Order>& orders)
+            {
+                if (success)
+                {
+                    for (const Order& order : orders)
+                    {
+                        TrackOrder(session, order);
+                    }
+                    for (auto order = m_order_sessions.begin(); order != m_order_sessions.end();)
+                    {
+                        const bool closed =
+                            order->second.session == session && order->second.tracked_at <= requested_at;
+                        order = closed ? m_order_sessions.erase(order) : std::next(order);
+                    }
+                    state->result.insert(state->result.end(), orders.begin(), orders.end());
+                }
+                state->success = state->success && success;
+                finish();
+            });
+        if (requested)
+        {
+            ++sent;
+        }
+        else
+        {
+            state->success = false;
+            --state->remaining;
+        }
+    }
+    if (sent == 0)
+    {
+        return false;
+    }
+    finish();
+    return true;
+}
+
+bool SessionManager::GetCurrentPositions(const std::string& currency, const std::string& kind,
+                                         PositionsCallback callback)
+{
+    using State = FanOut<std::vector<Position>, PositionsCallback>;
+    const auto state = std::make_shared<State>(State{m_sessions.size() + 1, true, {}, std::move(callback)});
+    const auto positions_by_instrument = std::make_shared<std::unordered_map<std::string, size_t>>();
+    const auto finish = [state]()
+    {
+        if (--state->remaining == 0 && state->callback)
+        {
+            state->callback(state->success, state->result);
+        }
+    };
+
+    size_t sent = 0;
+    for (Session& session : m_sessions)
+    {
+        ++session.request_count;
+        const bool requested = session.order_manager->GetCurrentPositions(
+            currency, kind,
+            [state, positions_by_instrument, finish](const bool success,
+                                                     const std::vector<Position>& positions)
+            {
+                for (const Position& position : positions)
+                {
+                    const auto [entry, inserted] =
+                        positions_by_instrument->emplace(position.instrument_name, state->result.size());
+                    if (inserted)
+                    {
+                        state->result.push_back(position);
+                    }
+                    else
+                    {
+                        MergePosition(state->result[entry->second], position);
+                    }
+                }
+                state->success = state->success && success;
+                finish();
+            });
+        if (requested)
+        {
+            ++sent;
+        }
+        else
+        {
+            state->success = false;
+            --state->remaining;
+        }
+    }
+    if (sent == 0)
+    {
+        return false;
+    }
+    finish();
+    return true;
+}
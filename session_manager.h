@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "order_manager.h"
+#include "token_manager.h"
+
+struct SessionConfig
+{
+    std::string name;  // e.g. "main" or a subaccount name; must be unique
+    std::string access_token_file;
+    std::string refresh_token_file;
+    std::string api_key_file;
+    std::string api_secret_file;
+    int expires_in{0};  // Seconds until the stored access token expires
+};
+
+using SessionId = uint32_t;
+
+// Holds one authenticated session per account or subaccount, each with its own TokenManager,
+// credentials and HTTP connection, so every account's rate-limit budget can be used at once.
+//
+// New orders are routed by strategy (the label up to its first '-', which also covers
+// ExecutionScheduler child labels), then by instrument, then round-robin over all sessions.
+// Cancels, edits and status requests follow the order id back to the session that placed it.
+// Open orders and positions are fetched from every session and merged into one result.
+//
+// Like OrderManager, callbacks run on drogon's main loop; call from that loop too.
+class SessionManager
+{
+  public:
+    static constexpr SessionId INVALID_SESSION = ~SessionId{0};
+
+  private:
+    struct Session
+    {
+        std::string name;
+        std::unique_ptr<TokenManager> token_manager;
+        std::unique_ptr<OrderManager> order_manager;  // Holds a reference to token_manager
+        uint64_t request_count{0};
+    };
+
+    // Owning session of an open order; tracked_at orders entries against open-order requests
+    struct OrderOwner
+    {
+        SessionId session;
+        uint64_t tracked_at;
+    };
+
+    std::vector<Session> m_sessions;
+    std::vector<std::pair<std::string, SessionId>> m_strategy_routes;  // Few entries; scanned in order
+    std::unordered_map<std::string, SessionId> m_instrument_routes;
+    std::unordered_map<std::string, OrderOwner> m_order_sessions;  // Keyed by order id
+    uint64_t m_track_sequence{0};
+    SessionId m_next_session{0};
+
+    static bool MatchesStrategy(const std::string& label, const std::string& strategy) noexcept;
+    SessionId Route(const OrderParams& params);
+    SessionId FindOrderSession(const std::string& order_id) const;
+    void TrackOrder(SessionId session, const Order& order);
+    OrderCallback MakeTrackingCallback(SessionId session, OrderCallback callback);
+
+  public:
+    // Reads the session's token and credential files; INVALID_SESSION if they cannot be read
+    SessionId AddSession(const SessionConfig& config);
+
+    size_t GetSessionCount() const noexcept;
+    SessionId FindSession(const std::string& name) const;
+    const std::string& GetSessionName(SessionId session) const;
+    uint64_t GetRequestCount(SessionId session) const;
+
+    // Per-account access, e.g. to run an ExecutionScheduler or OrderWatchdog on one session
+    const OrderManager& GetOrderManager(SessionId session) const;
+
+    // A later route for the same strategy or instrument replaces the earlier one
+    bool RouteStrategy(const std::string& strategy, SessionId session);
+    bool RouteInstrument(const std::string& instrument_name, SessionId session);
+
+    void SetDisplayResponses(bool display_responses) noexcept;
+
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+
+    // False without a request if the order id was not seen on any session
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+    bool GetOrderState(const std::string& order_id, OrderCallback callback = nullptr);
+
+    // Fan out to every session. The callback runs once all have answered; success is false if any
+    // session failed, and the result then holds what the others returned. Open orders are
+    // concatenated; positions are netted per instrument.
+    bool GetOpenOrders(OrdersCallback callback);
+    bool GetCurrentPositions(const std::string& currency, const std::string& kind,
+                             PositionsCallback callback);
+};
@@ -0,0 +1,93 @@
+#include "shared_memory_region.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <cstdint>
+#include <iostream>
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    Close();
+}
+
+// Session-local names, so the region is visible to processes of the same logon session only
+bool SharedMemoryRegion::Create(const std::string& name, const size_t size)
+{
+    Close();
+    const std::string object_name = "Local\\" + name;
+    const auto size64 = static_cast<uint64_t>(size);
+    m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFFu),
+                                   object_name.c_str());
+    if (m_mapping == nullptr)
+    {
+        std::cerr << "Failed to create shared memory " << object_name << ", error " << GetLastError() << "\n";
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        std::cerr << "Shared memory " << object_name << " already exists\n";
+        Close();
+        return false;
+    }
+
+    m_address = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (m_address == nullptr)
+    {
+        std::cerr << "Failed to map shared memory " << object_name << ", error " << GetLastError() << "\n";
+        Close();
+        return false;
+    }
+    m_size = size;
+    return true;
+}
+
+bool SharedMemoryRegion::OpenReadOnly(const std::string& name)
+{
+    Close();
+    const std::string object_name = "Local\\" + name;
+    m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, object_name.c_str());
+    if (m_mapping == nullptr)
+    {
+        std::cerr << "Failed to open shared memory " << object_name << ", error " << GetLastError() << "\n";
+        return false;
+    }
+
+    m_address = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (m_address == nullptr || VirtualQuery(m_address, &info, sizeof(info)) == 0)
+    {
+        std::cerr << "Failed to map shared memory " << object_name << ", error " << GetLastError() << "\n";
+        Close();
+        return false;
+    }
+    m_size = info.RegionSize;  // Rounded up to whole pages
+    return true;
+}
+
+void SharedMemoryRegion::Close()
+{
+    if (m_address != nullptr)
+    {
+        UnmapViewOfFile(m_address);
+        m_address = nullptr;
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_size = 0;
+}
+
+void* SharedMemoryRegion::GetAddress() const noexcept
+{
+    return m_address;
+}
+
+size_t SharedMemoryRegion::GetSize() const noexcept
+{
+    return m_size;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Named, page-file-backed memory mapping shared between processes on the same machine. The
+// creator maps it read-write; other processes open it by name read-only.
+class SharedMemoryRegion
+{
+  private:
+    void* m_mapping{nullptr};
+    void* m_address{nullptr};
+    size_t m_size{0};
+
+  public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    bool Create(const std::string& name, size_t size);
+    bool OpenReadOnly(const std::string& name);
+    void Close();
+
+    void* GetAddress() const noexcept;
+    size_t GetSize() const noexcept;
+};
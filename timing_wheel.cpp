@@ -0,0 +1,209 @@
+#include "timing_wheel.h"
+
+TimingWheel::TimingWheel(const std::chrono::nanoseconds tick, const size_t initial_capacity)
+    : m_heads(LEVELS * SLOTS + 1, NIL), m_origin(std::chrono::steady_clock::now()), m_tick(tick)
+{
+    m_nodes.reserve(initial_capacity);
+    m_free_nodes.reserve(initial_capacity);
+}
+
+void TimingWheel::SetExpiryHandler(ExpiryHandler handler)
+{
+    m_handler = std::move(handler);
+}
+
+uint64_t TimingWheel::ToTick(const std::chrono::steady_clock::time_point time) const
+{
+    if (time <= m_origin)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - m_origin) / m_tick);
+}
+
+void TimingWheel::Link(const uint32_t index, const uint32_t list)
+{
+    TimerNode& node = m_nodes[index];
+    node.list = list;
+    node.prev = NIL;
+    node.next = m_heads[list];
+    if (node.next != NIL)
+    {
+        m_nodes[node.next].prev = index;
+    }
+    m_heads[list] = index;
+}
+
+void TimingWheel::Unlink(const uint32_t index)
+{
+    TimerNode& node = m_nodes[index];
+    if (node.prev != NIL)
+    {
+        m_nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        m_heads[node.list] = node.next;
+    }
+    if (node.next != NIL)
+    {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+// Places a node by how far its expiry is from base, the first tick still to be expired. A node on
+// level L sits in the slot picked by bits [8L, 8L + 8) of its expiry, and is cascaded one level
+// down when the lower levels wrap onto that slot.
+void TimingWheel::Insert(const uint32_t index, const uint64_t base)
+{
+    TimerNode& node = m_nodes[index];
+    if (node.expiry_tick < base)
+    {
+        node.expiry_tick = base;
+    }
+
+    const uint64_t delta = node.expiry_tick - base;
+    uint32_t level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1))))
+    {
+        ++level;
+    }
+    // Beyond the top level's span the node parks in the furthest slot and is re-placed when
+    // that slot cascades
+    const uint64_t span_end = base + (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    const uint64_t placement = node.expiry_tick < span_end ? node.expiry_tick : span_end;
+    const uint32_t slot = static_cast<uint32_t>(placement >> (SLOT_BITS * level)) & SLOT_MASK;
+    Link(index, level * SLOTS + slot);
+}
+
+// Moves a whole slot list onto the detached list so it can be drained while handlers schedule
+// or cancel timers, possibly into the same slot
+void TimingWheel::Detach(const uint32_t list)
+{
+    uint32_t index = m_heads[list];
+    m_heads[list] = NIL;
+    while (index != NIL)
+    {
+        const uint32_t next = m_nodes[index].next;
+        Link(index, DETACHED_LIST);
+        index = next;
+    }
+}
+
+void TimingWheel::Release(const uint32_t index)
+{
+    TimerNode& node = m_nodes[index];
+    node.list = NIL;
+    ++node.generation;
+    m_free_nodes.push_back(index);
+    --m_active_count;
+}
+
+void TimingWheel::Cascade(const uint32_t level)
+{
+    const uint32_t slot = static_cast<uint32_t>(m_current_tick >> (SLOT_BITS * level)) & SLOT_MASK;
+    Detach(level * SLOTS + slot);
+    while (m_heads[DETACHED_LIST] != NIL)
+    {
+        const uint32_t index = m_heads[DETACHED_LIST];
+        Unlink(index);
+        Insert(index, m_current_tick);  // The current tick's level 0 slot has not fired yet
+    }
+}
+
+TimerHandle TimingWheel::ScheduleAt(const std::chrono::steady_clock::time_point deadline, const uint32_t kind,
+                                    const uint64_t payload)
+{
+    uint32_t index;
+    if (!m_free_nodes.empty())
+    {
+        index = m_free_nodes.back();
+        m_free_nodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    TimerNode& node = m_nodes[index];
+    node.expiry_tick = ToTick(deadline);
+    node.kind = kind;
+    node.payload = payload;
+    Insert(index, m_current_tick + 1);
+    ++m_active_count;
+    return (static_cast<TimerHandle>(node.generation) << 32) | index;
+}
+
+TimerHandle TimingWheel::ScheduleAfter(const std::chrono::nanoseconds delay, const uint32_t kind,
+                                       const uint64_t payload)
+{
+    return ScheduleAt(std::chrono::steady_clock::now() + delay, kind, payload);
+}
+
+bool TimingWheel::Cancel(const TimerHandle handle)
+{
+    const auto index = static_cast<uint32_t>(handle & 0xFFFFFFFFu);
+    if (handle == INVALID_TIMER || index >= m_nodes.size())
+    {
+        return false;
+    }
+    const TimerNode& node = m_nodes[index];
+    if (node.list == NIL || node.generation != static_cast<uint32_t>(handle >> 32))
+    {
+        return false;  // Already fired or cancelled
+    }
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+void TimingWheel::Advance(const std::chrono::steady_clock::time_point now)
+{
+    const uint64_t target = ToTick(now);
+    if (m_active_count == 0 && target > m_current_tick)
+    {
+        m_current_tick = target;  // Nothing armed; skip the idle ticks outright
+        return;
+    }
+
+    while (m_current_tick < target)
+    {
+        ++m_current_tick;
+
+        // Cascade from the highest level whose lower levels just wrapped
+        for (uint32_t level = LEVELS - 1; level > 0; --level)
+        {
+            if ((m_current_tick & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0)
+            {
+                Cascade(level);
+            }
+        }
+
+        Detach(static_cast<uint32_t>(m_current_tick) & SLOT_MASK);
+        while (m_heads[DETACHED_LIST] != NIL)
+        {
+            const uint32_t index = m_heads[DETACHED_LIST];
+            Unlink(index);
+            const uint32_t kind = m_nodes[index].kind;
+            const uint64_t payload = m_nodes[index].payload;
+            Release(index);
+            if (m_handler)
+            {
+                m_handler(kind, payload);
+            }
+        }
+
+        if (m_active_count == 0)
+        {
+            m_current_tick = target;
+        }
+    }
+}
+
+size_t TimingWheel::GetActiveCount() const noexcept
+{
+    return m_active_count;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using TimerHandle = uint64_t;
+
+// Hierarchical timing wheel: four levels of 256 slots, so with a 1 ms tick timers can be up to
+// ~49 days out. Schedule and Cancel are O(1); Advance does O(1) work per elapsed tick plus the
+// timers it expires or cascades down a level. Timer nodes are pooled and intrusively linked, and
+// each carries a (kind, payload) pair instead of a closure, so arming a timer never allocates
+// once the pool has grown to its working size.
+//
+// Not thread-safe: schedule, cancel and advance from the same event loop.
+class TimingWheel
+{
+  public:
+    static constexpr TimerHandle INVALID_TIMER = ~TimerHandle{0};
+
+    using ExpiryHandler = std::function<void(uint32_t kind, uint64_t payload)>;
+
+  private:
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t DETACHED_LIST = LEVELS * SLOTS;  // Expiring/cascading list head
+    static constexpr uint32_t NIL = ~uint32_t{0};
+
+    struct TimerNode
+    {
+        uint64_t expiry_tick{0};
+        uint64_t payload{0};
+        uint32_t kind{0};
+        uint32_t generation{0};
+        uint32_t list{NIL};  // Slot list the node is linked into, NIL when free
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+    };
+
+    std::vector<TimerNode> m_nodes;
+    std::vector<uint32_t> m_free_nodes;
+    std::vector<uint32_t> m_heads;
+    ExpiryHandler m_handler;
+    std::chrono::steady_clock::time_point m_origin;
+    std::chrono::nanoseconds m_tick;
+    uint64_t m_current_tick{0};  // Last tick processed
+    size_t m_active_count{0};
+
+    void Link(uint32_t index, uint32_t list);
+    void Unlink(uint32_t index);
+    void Insert(uint32_t index, uint64_t base);
+    void Detach(uint32_t list);
+    void Release(uint32_t index);
+    void Cascade(uint32_t level);
+
+  public:
+    TimingWheel(std::chrono::nanoseconds tick, size_t initial_capacity);
+
+    void SetExpiryHandler(ExpiryHandler handler);
+
+    uint64_t ToTick(std::chrono::steady_clock::time_point time) const;
+
+    TimerHandle ScheduleAt(std::chrono::steady_clock::time_point deadline, uint32_t kind, uint64_t payload);
+    TimerHandle ScheduleAfter(std::chrono::nanoseconds delay, uint32_t kind, uint64_t payload);
+    bool Cancel(TimerHandle handle);
+
+    // Expires every timer due at or before now, invoking the handler for each
+    void Advance(std::chrono::steady_clock::time_point now);
+
+    size_t GetActiveCount() const noexcept;
+};
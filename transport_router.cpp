@@ -0,0 +1,409 @@
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+TransportRouter::~TransportRouter()
+{
+    Stop();
+}
+
+PathId TransportRouter::AddHttpPath(const std::string& name, const OrderManager& order_manager)
+{
+    return AddPath(name, TransportKind::HTTP, &order_manager, nullptr);
+}
+
+PathId TransportRouter::AddSocketPath(const std::string& name, OrderEntrySocket& socket)
+{
+    return AddPath(name, TransportKind::WEBSOCKET, nullptr, &socket);
+}
+
+PathId TransportRouter::AddPath(const std::string& name, const TransportKind kind, const OrderManager* http,
+                                OrderEntrySocket* socket)
+{
+    const auto path_id = static_cast<PathId>(m_paths.size());
+    Path& path = m_paths.emplace_back();
+    path.name = name;
+    path.kind = kind;
+    path.http = http;
+    path.socket = socket;
+    if (m_active == INVALID_PATH)
+    {
+        m_active = path_id;
+    }
+    return path_id;
+}
+
+void TransportRouter::SetProbeInterval(const std::chrono::milliseconds interval) noexcept
+{
+    m_probe_interval = interval;
+}
+
+void TransportRouter::SetProbeTimeout(const std::chrono::milliseconds timeout) noexcept
+{
+    m_probe_timeout = timeout;
+}
+
+size_t TransportRouter::GetBucket(const double rtt_us) noexcept
+{
+    const uint64_t value = rtt_us < 1.0 ? 1 : static_cast<uint64_t>(std::min(rtt_us, 1e18));
+    size_t exponent = 0;
+    while ((value >> (exponent + 1)) != 0)
+    {
+        ++exponent;
+    }
+    // The two bits below the leading one pick the quarter within the power of two
+    const size_t quarter = static_cast<size_t>(((value << 2) >> exponent) & 3);
+    return std::min(exponent * SUB_BUCKETS + quarter, BUCKET_COUNT - 1);
+}
+
+double TransportRouter::GetBucketLimit(const size_t bucket) noexcept
+{
+    const double base = std::ldexp(1.0, static_cast<int>(bucket / SUB_BUCKETS));
+    return base + base * static_cast<double>(bucket % SUB_BUCKETS + 1) / SUB_BUCKETS;
+}
+
+double TransportRouter::GetPercentile(const Path& path, const double fraction) noexcept
+{
+    if (path.samples == 0)
+    {
+        return 0.0;
+    }
+    const auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(path.samples)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+    {
+        seen += path.buckets[bucket];
+        if (seen >= rank && seen > 0)
+        {
+            return std::min(GetBucketLimit(bucket), path.max_us);
+        }
+    }
+    return path.max_us;
+}
+
+// Unmeasured paths score worst, so any measured healthy path is preferred to them
+double TransportRouter::GetScore(const Path& path) const noexcept
+{
+    if (path.smoothed_rtt_us == 0.0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return path.smoothed_rtt_us * (1.0 + ERROR_PENALTY * path.error_rate);
+}
+
+void TransportRouter::RecordRoundTrip(const PathId path_id, const std::chrono::steady_clock::duration rtt)
+{
+    Path& path = m_paths[path_id];
+    const double rtt_us = std::chrono::duration<double, std::micro>(rtt).count();
+    path.smoothed_rtt_us =
+        path.smoothed_rtt_us == 0.0 ? rtt_us : path.smoothed_rtt_us + SMOOTHING * (rtt_us - path.smoothed_rtt_us);
+    path.error_rate -= SMOOTHING * path.error_rate;
+    path.consecutive_failures = 0;
+    if (!path.healthy)
+    {
+        std::cout << "Order entry path " << path.name << " recovered\n";
+        path.healthy = true;
+    }
+
+    ++path.buckets[GetBucket(rtt_us)];
+    ++path.samples;
+    path.total_us += rtt_us;
+    path.max_us = std::max(path.max_us, rtt_us);
+}
+
+// A refused send means the path cannot carry orders right now, so it goes down at once
+void TransportRouter::RecordFailure(const PathId path_id, const bool refused)
+{
+    Path& path = m_paths[path_id];
+    path.error_rate += SMOOTHING * (1.0 - path.error_rate);
+    path.consecutive_failures = refused ? MAX_CONSECUTIVE_FAILURES : path.consecutive_failures + 1;
+    if (path.healthy && path.consecutive_failures >= MAX_CONSECUTIVE_FAILURES)
+    {
+        std::cerr << "Order entry path " << path.name << " is unhealthy\n";
+        path.healthy = false;
+    }
+}
+
+void TransportRouter::SelectActive()
+{
+    PathId best = INVALID_PATH;
+    double best_score = 0.0;
+    for (PathId path_id = 0; path_id < m_paths.size(); ++path_id)
+    {
+        const Path& path = m_paths[path_id];
+        const double score = GetScore(path);
+        if (path.healthy && (best == INVALID_PATH || score < best_score))
+        {
+            best = path_id;
+            best_score = score;
+        }
+    }
+    // With every path down, stay put; the next successful probe picks again
+    if (best == INVALID_PATH || best == m_active)
+    {
+        return;
+    }
+    const Path& active = m_paths[m_active];
+    if (active.healthy && best_score >= GetScore(active) * (1.0 - SWITCH_MARGIN))
+    {
+        return;
+    }
+    std::cout << "Order entry moved from " << active.name << " to " << m_paths[best].name << "\n";
+    m_active = best;
+}
+
+void TransportRouter::Probe(const PathId path_id, const std::chrono::steady_clock::time_point now)
+{
+    Path& path = m_paths[path_id];
+    if (path.probe_outstanding)
+    {
+        if (now - path.probe_sent < m_probe_timeout)
+        {
+            return;
+        }
+        path.probe_outstanding = false;
+        ++path.probe_failures;
+        RecordFailure(path_id, false);
+    }
+
+    const uint64_t sequence = ++path.probe_sequence;
+    path.probe_outstanding = true;
+    path.probe_sent = now;
+    ++path.probes;
+
+    ProbeCallback callback = [this, path_id, sequence, sent = std::chrono::steady_clock::now()](const bool success)
+    {
+        Path& probed = m_paths[path_id];
+        if (!probed.probe_outstanding || probed.probe_sequence != sequence)
+        {
+            return;  // Already counted as timed out
+        }
+        probed.probe_outstanding = false;
+        if (success)
+        {
+            RecordRoundTrip(path_id, std::chrono::steady_clock::now() - sent);
+        }
+        else
+        {
+            ++probed.probe_failures;
+            RecordFailure(path_id, false);
+        }
+        SelectActive();
+    };
+    const bool sent =
+        path.http != nullptr ? path.http->Ping(std::move(callback)) : path.socket->Ping(std::move(callback));
+    if (!sent)
+    {
+        path.probe_outstanding = false;
+        ++path.probe_failures;
+        RecordFailure(path_id, false);
+    }
+}
+
+void TransportRouter::ProbeAll(const std::chrono::steady_clock::time_point now)
+{
+    for (PathId path_id = 0; path_id < m_paths.size(); ++path_id)
+    {
+        Probe(path_id, now);
+    }
+    SelectActive();
+}
+
+void TransportRouter::Start(trantor::EventLoop* loop)
+{
+    Stop();
+    m_loop = loop;
+    const double interval_seconds = std::chrono::duration<double>(m_probe_interval).count();
+    m_timer_id = m_loop->runEvery(interval_seconds, [this]() { ProbeAll(std::chrono::steady_clock::now()); });
+    ProbeAll(std::chrono::steady_clock::now());
+}
+
+void TransportRouter::Stop()
+{
+    if (m_loop != nullptr)
+    {
+        m_loop->invalidateTimer(m_timer_id);
+        m_loop = nullptr;
+    }
+}
+
+// Successful replies are round-trip samples too; failed ones may be exchange rejections, which
+// say nothing about the path
+void TransportRouter::CompleteRequest(TimedRequest* const request, const uint64_t sequence, const bool success,
+                                      const Order& order)
+{
+    if (request->sequence != sequence)
+    {
+        return;
+    }
+    request->sequence = 0;
+    if (success)
+    {
+        RecordRoundTrip(request->path_id, std::chrono::steady_clock::now() - request->sent);
+    }
+    // Released before the callback runs, since it may route another order
+    const OrderCallback callback = std::move(request->callback);
+    request->callback = nullptr;
+    m_requests.Release(request);
+    if (callback)
+    {
+        callback(success, order);
+    }
+}
+
+// The active path first; each one that refuses is marked down and the next best is tried
+template <typename Send>
+bool TransportRouter::Dispatch(const Send& send, OrderCallback callback)
+{
+    if (m_active == INVALID_PATH)
+    {
+        std::cerr << "No order entry paths configured\n";
+        return false;
+    }
+
+    TimedRequest* const request = m_requests.Acquire();
+    request->router = this;
+    request->callback = std::move(callback);
+    std::vector<bool> tried;
+    PathId candidate = m_active;
+    while (candidate != INVALID_PATH)
+    {
+        Path& path = m_paths[candidate];
+        request->path_id = candidate;
+        request->sequence = ++m_request_sequence;
+        request->sent = std::chrono::steady_clock::now();
+        // Sixteen bytes, small enough for std::function to hold without allocating
+        const auto complete = [request, sequence = request->sequence](const bool success, const Order& order)
+        { request->router->CompleteRequest(request, sequence, success, order); };
+        if (send(path, complete))
+        {
+            ++path.orders;
+            return true;
+        }
+        ++path.send_failures;
+        RecordFailure(candidate, true);
+        SelectActive();
+
+        if (tried.empty())
+        {
+            tried.assign(m_paths.size(), false);
+        }
+        tried[candidate] = true;
+        candidate = INVALID_PATH;
+        for (PathId path_id = 0; path_id < m_paths.size(); ++path_id)
+        {
+            // Healthy paths by score, then unhealthy ones as a last resort
+            const Path& next = m_paths[path_id];
+            if (tried[path_id])
+            {
+                continue;
+            }
+            if (candidate == INVALID_PATH || (next.healthy && !m_paths[candidate].healthy) ||
+                (next.healthy == m_paths[candidate].healthy && GetScore(next) < GetScore(m_paths[candidate])))
+            {
+                candidate = path_id;
+            }
+        }
+    }
+    request->sequence = 0;
+    request->callback = nullptr;
+    m_requests.Release(request);
+    std::cerr << "No order entry path accepted the request\n";
+    return false;
+}
+
+bool TransportRouter::PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback)
+{
+    // Checked here so an order no path can send does not take every path down with it
+    if (params.type != OrderType::LIMIT && params.type != OrderType::MARKET)
+    {
+        std::cerr << "Unsupported order type.\n";
+        return false;
+    }
+    return Dispatch(
+        [&params, &side](Path& path, OrderCallback timed)
+        {
+            return path.http != nullptr ? path.http->PlaceOrder(params, side, std::move(timed))
+                                        : path.socket->PlaceOrder(params, side, std::move(timed));
+        },
+        std::move(callback));
+}
+
+bool TransportRouter::CancelOrder(const std::string& order_id, OrderCallback callback)
+{
+    return Dispatch(
+        [&order_id](Path& path, OrderCallback timed)
+        {
+            return path.http != nullptr ? path.http->CancelOrder(order_id, std::move(timed))
+                                        : path.socket->CancelOrder(order_id, std::move(timed));
+        },
+        std::move(callback));
+}
+
+bool TransportRouter::ModifyOrder(const std::string& order_id, const double new_amount, const double new_price,
+                                  OrderCallback callback)
+{
+    return Dispatch(
+        [&order_id, new_amount, new_price](Path& path, OrderCallback timed)
+        {
+            return path.http != nullptr ? path.http->ModifyOrder(order_id, new_amount, new_price, std::move(timed))
+                                        : path.socket->ModifyOrder(order_id, new_amount, new_price, std::move(timed));
+        },
+        std::move(callback));
+}
+
+size_t TransportRouter::GetPathCount() const noexcept
+{
+    return m_paths.size();
+}
+
+PathId TransportRouter::GetActivePath() const noexcept
+{
+    return m_active;
+}
+
+PathStats TransportRouter::GetPathStats(const PathId path_id) const
+{
+    PathStats stats;
+    if (path_id >= m_paths.size())
+    {
+        return stats;
+    }
+    const Path& path = m_paths[path_id];
+    stats.name = path.name;
+    stats.kind = path.kind;
+    stats.healthy = path.healthy;
+    stats.active = path_id == m_active;
+    stats.smoothed_rtt_us = path.smoothed_rtt_us;
+    stats.error_rate = path.error_rate;
+    stats.probes = path.probes;
+    stats.probe_failures = path.probe_failures;
+    stats.orders = path.orders;
+    stats.send_failures = path.send_failures;
+    stats.latency.samples = path.samples;
+    stats.latency.mean_us = path.samples > 0 ? path.total_us / static_cast<double>(path.samples) : 0.0;
+    stats.latency.p50_us = GetPercentile(path, 0.50);
+    stats.latency.p90_us = GetPercentile(path, 0.90);
+    stats.latency.p99_us = GetPercentile(path, 0.99);
+    stats.latency.max_us = path.max_us;
+    return stats;
+}
+
+const PoolStats& TransportRouter::GetRequestPoolStats() const noexcept
+{
+    return m_requests.GetStats();
+}
+
+void TransportRouter::ResetLatency()
+{
+    for (Path& path : m_paths)
+    {
+        path.buckets.fill(0);
+        path.samples = 0;
+        path.total_us = 0.0;
+        path.max_us = 0.0;
+    }
+}
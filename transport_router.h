@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <trantor/net/EventLoop.h>
+
+#include "object_pool.h"
+#include "order_entry_socket.h"
+#include "order_manager.h"
+
+enum class TransportKind
+{
+    HTTP,
+    WEBSOCKET
+};
+
+using PathId = uint32_t;
+
+// Round-trip distribution over probes and successful orders since the last reset, in microseconds.
+// Percentiles are bucket upper bounds, accurate to within a quarter of a power of two.
+struct PathLatency
+{
+    uint64_t samples{0};
+    double mean_us{0.0};
+    double p50_us{0.0};
+    double p90_us{0.0};
+    double p99_us{0.0};
+    double max_us{0.0};
+};
+
+struct PathStats
+{
+    std::string name;
+    TransportKind kind{TransportKind::HTTP};
+    bool healthy{true};
+    bool active{false};
+    double smoothed_rtt_us{0.0};  // Exponentially weighted, so it tracks the path's current state
+    double error_rate{0.0};       // Exponentially weighted share of failed probes and sends
+    uint64_t probes{0};
+    uint64_t probe_failures{0};
+    uint64_t orders{0};
+    uint64_t send_failures{0};  // Requests the path refused to send, each followed by a failover
+    PathLatency latency;
+};
+
+// Sends each order over whichever order-entry path is currently fastest and healthy: the
+// WebSocket session, or any of several HTTP connections (an OrderManager each; they can share one
+// TokenManager). Every path is probed with public/test each probe interval, and successful
+// order round trips are measured too. A path's score is its smoothed RTT inflated by its error
+// rate. The active path changes only when another one scores clearly better, so routing does not
+// flap between near-equal paths.
+//
+// A path that misses MAX_CONSECUTIVE_FAILURES probes in a row, or refuses a send, is marked
+// unhealthy and traffic fails over at once; a later successful probe brings it back. An order
+// whose send was refused is retried on the next best path; an order that was sent is never
+// resent, since the exchange may already have it.
+//
+// Routing allocates nothing once warm: each order's timing state comes from a pool and the
+// callback handed to the path carries only a pointer to it. A path that drops a callback without
+// calling it keeps its pool slot until the router is destroyed.
+//
+// Probes, orders and callbacks run on drogon's main loop; call from that loop too.
+class TransportRouter
+{
+  public:
+    static constexpr PathId INVALID_PATH = ~PathId{0};
+    static constexpr uint32_t MAX_CONSECUTIVE_FAILURES = 3;
+    static constexpr double SMOOTHING = 0.2;       // Weight of each new sample
+    static constexpr double ERROR_PENALTY = 4.0;   // A 25% error rate doubles a path's score
+    static constexpr double SWITCH_MARGIN = 0.2;   // A challenger must score this much lower
+
+  private:
+    // Log-linear buckets: four per power of two of microseconds, up to about 70 minutes
+    static constexpr size_t SUB_BUCKETS = 4;
+    static constexpr size_t BUCKET_COUNT = 32 * SUB_BUCKETS;
+
+    struct Path
+    {
+        std::string name;
+        TransportKind kind;
+        const OrderManager* http{nullptr};
+        OrderEntrySocket* socket{nullptr};
+
+        bool healthy{true};
+        uint32_t consecutive_failures{0};
+        double smoothed_rtt_us{0.0};
+        double error_rate{0.0};
+        uint64_t probes{0};
+        uint64_t probe_failures{0};
+        uint64_t orders{0};
+        uint64_t send_failures{0};
+
+        uint64_t probe_sequence{0};
+        bool probe_outstanding{false};
+        std::chrono::steady_clock::time_point probe_sent;
+
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t samples{0};
+        double total_us{0.0};
+        double max_us{0.0};
+    };
+
+    // An order in flight on a path, until its reply or a refusal on every path
+    struct TimedRequest
+    {
+        TransportRouter* router{nullptr};
+        uint64_t sequence{0};  // Changes with each send, so a repeated or stale callback is ignored
+        PathId path_id{INVALID_PATH};
+        OrderCallback callback;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    std::vector<Path> m_paths;
+    ObjectPool<TimedRequest> m_requests;
+    uint64_t m_request_sequence{0};
+    PathId m_active{INVALID_PATH};
+    std::chrono::milliseconds m_probe_interval{250};
+    std::chrono::milliseconds m_probe_timeout{1000};
+    trantor::EventLoop* m_loop{nullptr};
+    trantor::TimerId m_timer_id{0};
+
+    static size_t GetBucket(double rtt_us) noexcept;
+    static double GetBucketLimit(size_t bucket) noexcept;
+    static double GetPercentile(const Path& path, double fraction) noexcept;
+
+    PathId AddPath(const std::string& name, TransportKind kind, const OrderManager* http,
+                   OrderEntrySocket* socket);
+    double GetScore(const Path& path) const noexcept;
+    void RecordRoundTrip(PathId path_id, std::chrono::steady_clock::duration rtt);
+    void RecordFailure(PathId path_id, bool refused);
+    void SelectActive();
+    void Probe(PathId path_id, std::chrono::steady_clock::time_point now);
+    void CompleteRequest(TimedRequest* request, uint64_t sequence, bool success, const Order& order);
+    template <typename Send>
+    bool Dispatch(const Send& send, OrderCallback callback);
+
+  public:
+    TransportRouter() = default;
+    ~TransportRouter();
+    TransportRouter(const TransportRouter&) = delete;
+    TransportRouter& operator=(const TransportRouter&) = delete;
+
+    // Paths are not owned and must outlive the router. Until probes have measured them, the
+    // first path added carries the traffic.
+    PathId AddHttpPath(const std::string& name, const OrderManager& order_manager);
+    PathId AddSocketPath(const std::string& name, OrderEntrySocket& socket);
+
+    // A probe unanswered after the timeout counts as failed. The interval takes effect at the next Start.
+    void SetProbeInterval(std::chrono::milliseconds interval) noexcept;
+    void SetProbeTimeout(std::chrono::milliseconds timeout) noexcept;
+
+    // Sends one probe per path that has none outstanding, expiring overdue ones first
+    void ProbeAll(std::chrono::steady_clock::time_point now);
+    void Start(trantor::EventLoop* loop);
+    void Stop();
+
+    bool PlaceOrder(const OrderParams& params, const std::string& side, OrderCallback callback = nullptr);
+    bool CancelOrder(const std::string& order_id, OrderCallback callback = nullptr);
+    bool ModifyOrder(const std::string& order_id, double new_amount, double new_price,
+                     OrderCallback callback = nullptr);
+
+    size_t GetPathCount() const noexcept;
+    PathId GetActivePath() const noexcept;
+    PathStats GetPathStats(PathId path_id) const;
+    const PoolStats& GetRequestPoolStats() const noexcept;
+
+    // Clears the latency distributions, e.g. after each monitoring snapshot; health is kept
+    void ResetLatency();
+};
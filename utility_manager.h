@@ -1,18 +1,22 @@
-#pragma once
-#include <string>
-
-#include <drogon/drogon.h>
-
-class UtilityManager
-{
-  public:
-    static void HandleExitSignal(const int signal);
-    static void DisplayJsonResponse(const std::string& response);
-
-    static std::string DisplayFormattedTimestamp(const int64_t& timestamp_ms);
-
-    static void DisplayCurrentPositionsJson(const std::string& response);
-    static bool IsParseJsonGood(const std::string& response, Json::Value& json_data);
-
-    static void DisplayOrderBookJson(const std::string& response);
-};
+#pragma once
+#include <string>
+#include <vector>
+
+#include <drogon/drogon.h>
+
+#include "exchange_types.h"
+
+class UtilityManager
+{
+  public:
+    static void HandleExitSignal(const int signal);
+    static void DisplayOrder(const Order& order);
+    static void DisplayOpenOrders(const std::vector<Order>& orders);
+
+    static std::string DisplayFormattedTimestamp(const int64_t& timestamp_ms);
+
+    static void DisplayCurrentPositions(const std::vector<Position>& positions);
+    static bool IsParseJsonGood(const std::string& response, Json::Value& json_data);
+
+    static void DisplayOrderBook(const OrderBookSnapshot& book);
+};
@@ -1,142 +1,184 @@
-#include "web_socket_client.h"
-
-#include <chrono>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
-
-DrogonWebSocket::DrogonWebSocket() = default;
-
-DrogonWebSocket::~DrogonWebSocket()
-{
-    if (ws_client && is_connected)
-    {
-        ws_client->stop();
-    }
-}
-
-// Function to get the current timestamp in HH:MM:SS.mmm format
-std::string DrogonWebSocket::GetFormattedTimestamp()
-{
-    const auto now = std::chrono::system_clock::now();
-    const auto now_time = std::chrono::system_clock::to_time_t(now);
-    const auto ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
-
-    struct tm timeinfo;
-    char timestamp[20];
-    localtime_s(&timeinfo, &now_time);
-    std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &timeinfo);
-
-    std::stringstream ss;
-    ss << timestamp << "." << std::setfill('0') << std::setw(3) << ms;
-    return ss.str();
-}
-
-// Function to connect to the WebSocket server and subscribe to a symbol
-void DrogonWebSocket::ConnectToServer(const std::string& symbol)
-{
-    ws_symbol = symbol;
-
-    try
-    {
-        std::cout << GetFormattedTimestamp() << " Connecting to Deribit WebSocket...\n";
-
-        const auto req = drogon::HttpRequest::newHttpRequest();
-        req->setPath("/ws/api/v2");
-        req->setMethod(drogon::Get);
-
-        ws_client = drogon::WebSocketClient::newWebSocketClient("wss://test.deribit.com");
-
-        ws_client->setMessageHandler(
-            [this](std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
-                   const drogon::WebSocketMessageType& type)
-            {
-                HandleMessage(std::move(msg), ws_ptr, type);
-            });
-
-        const drogon::WebSocketRequestCallback callback =
-            [this, symbol](const drogon::ReqResult& result, const drogon::HttpResponsePtr& resp,
-                           const drogon::WebSocketClientPtr& ws_conn)
-        {
-            if (result == drogon::ReqResult::Ok)
-            {
-                is_connected = true;
-                std::cout << GetFormattedTimestamp() << " Connected!\n";
-                SubscribeToSymbol(symbol);
-            }
-            else
-            {
-                std::cerr << GetFormattedTimestamp()
-                          << " Failed to connect: " << (resp ? std::to_string(resp->getStatusCode()) : "N/A")
-                          << "\n";
-            }
-        };
-
-        ws_client->connectToServer(req, callback);
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << GetFormattedTimestamp() << " Exception: " << e.what() << "\n";
-    }
-}
-
-// Function to subscribe to a symbol on the WebSocket server
-void DrogonWebSocket::SubscribeToSymbol(const std::string& symbol)
-{
-    try
-    {
-        Json::Value msg;
-        msg["jsonrpc"] = "2.0";
-        msg["method"] = "public/subscribe";
-        msg["params"]["channels"] = Json::Value(Json::arrayValue);
-        msg["params"]["channels"].append("ticker." + symbol + ".100ms");
-        msg["id"] = 0;
-
-        const Json::StreamWriterBuilder writer;
-        const std::string msg_str = Json::writeString(writer, msg);
-        const drogon::WebSocketConnectionPtr& ws_conn = ws_client->getConnection();
-        ws_conn->send(msg_str);
-        std::cout << GetFormattedTimestamp() << " Subscription request sent for: " << symbol << "\n";
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << GetFormattedTimestamp() << " Exception during subscription: " << e.what() << "\n";
-    }
-}
-
-// Function to handle incoming messages from the WebSocket server
-void DrogonWebSocket::HandleMessage(std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
-                                    const drogon::WebSocketMessageType& type)
-{
-    try
-    {
-        if (type == drogon::WebSocketMessageType::Text)
-        {
-            Json::Value json_data;
-            const Json::CharReaderBuilder reader_builder;
-            std::string errs;
-            std::istringstream s(msg);
-
-            if (Json::parseFromStream(reader_builder, s, &json_data, &errs))
-            {
-                if (json_data.isMember("params"))
-                {
-                    const auto& params = json_data["params"];
-                    if (params.isMember("channel") && params.isMember("data"))
-                    {
-                        std::cout << GetFormattedTimestamp() << " " << params["channel"].asString() << "\n";
-                    }
-                }
-            }
-            else
-            {
-                std::cerr << GetFormattedTimestamp() << " Failed to parse message: " << errs << "\n";
-            }
-        }
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << GetFormattedTimestamp() << " Exception processing message: " << e.what() << "\n";
-    }
-}
+#include "web_socket_client.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+#include "response_decoder.h"
+
+DrogonWebSocket::DrogonWebSocket() = default;
+
+DrogonWebSocket::~DrogonWebSocket()
+{
+    if (ws_client && is_connected)
+    {
+        ws_client->stop();
+    }
+}
+
+// Function to get the current timestamp in HH:MM:SS.mmm format
+std::string DrogonWebSocket::GetFormattedTimestamp()
+{
+    const auto now = std::chrono::system_clock::now();
+    const auto now_time = std::chrono::system_clock::to_time_t(now);
+    const auto ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+
+    struct tm timeinfo;
+    char timestamp[20];
+    localtime_s(&timeinfo, &now_time);
+    const size_t length = std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &timeinfo);
+
+    // Twelve characters fit the string's inline buffer, so this runs on every message without allocating
+    std::snprintf(timestamp + length, sizeof(timestamp) - length, ".%03d", static_cast<int>(ms));
+    return timestamp;
+}
+
+void DrogonWebSocket::AddTickerHandler(TickerHandler handler)
+{
+    ticker_handlers.push_back(std::move(handler));
+}
+
+void DrogonWebSocket::AddTradeHandler(TradeHandler handler)
+{
+    trade_handlers.push_back(std::move(handler));
+}
+
+// Function to connect to the WebSocket server and subscribe to a symbol
+void DrogonWebSocket::ConnectToServer(const std::string& symbol)
+{
+    ConnectToServer(std::vector<std::string>{symbol});
+}
+
+// Function to connect to the WebSocket server and subscribe to several symbols
+void DrogonWebSocket::ConnectToServer(const std::vector<std::string>& symbols)
+{
+    ws_symbols = symbols;
+
+    try
+    {
+        std::cout << GetFormattedTimestamp() << " Connecting to Deribit WebSocket...\n";
+
+        const auto req = drogon::HttpRequest::newHttpRequest();
+        req->setPath("/ws/api/v2");
+        req->setMethod(drogon::Get);
+
+        ws_client = drogon::WebSocketClient::newWebSocketClient("wss://test.deribit.com");
+
+        ws_client->setMessageHandler(
+            [this](std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
+                   const drogon::WebSocketMessageType& type)
+            {
+                HandleMessage(std::move(msg), ws_ptr, type);
+            });
+
+        const drogon::WebSocketRequestCallback callback =
+            [this](const drogon::ReqResult& result, const drogon::HttpResponsePtr& resp,
+                   const drogon::WebSocketClientPtr& ws_conn)
+        {
+            if (result == drogon::ReqResult::Ok)
+            {
+                is_connected = true;
+                std::cout << GetFormattedTimestamp() << " Connected!\n";
+                SubscribeToSymbols();
+            }
+            else
+            {
+                std::cerr << GetFormattedTimestamp()
+                          << " Failed to connect: " << (resp ? std::to_string(resp->getStatusCode()) : "N/A")
+                          << "\n";
+            }
+        };
+
+        ws_client->connectToServer(req, callback);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << GetFormattedTimestamp() << " Exception: " << e.what() << "\n";
+    }
+}
+
+// Function to subscribe to the symbols on the WebSocket server
+void DrogonWebSocket::SubscribeToSymbols()
+{
+    try
+    {
+        Json::Value msg;
+        msg["jsonrpc"] = "2.0";
+        msg["method"] = "public/subscribe";
+        msg["params"]["channels"] = Json::Value(Json::arrayValue);
+        for (const std::string& symbol : ws_symbols)
+        {
+            msg["params"]["channels"].append("ticker." + symbol + ".100ms");
+            if (!trade_handlers.empty())
+            {
+                msg["params"]["channels"].append("trades." + symbol + ".100ms");
+            }
+        }
+        msg["id"] = 0;
+
+        const Json::StreamWriterBuilder writer;
+        const std::string msg_str = Json::writeString(writer, msg);
+        const drogon::WebSocketConnectionPtr& ws_conn = ws_client->getConnection();
+        ws_conn->send(msg_str);
+        std::cout << GetFormattedTimestamp() << " Subscription request sent for " << ws_symbols.size()
+                  << " symbols\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << GetFormattedTimestamp() << " Exception during subscription: " << e.what() << "\n";
+    }
+}
+
+// Function to handle incoming messages from the WebSocket server
+void DrogonWebSocket::HandleMessage(std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
+                                    const drogon::WebSocketMessageType& type)
+{
+    try
+    {
+        if (type == drogon::WebSocketMessageType::Text)
+        {
+            std::string_view channel;
+            std::string_view data;
+            if (!ResponseDecoder::DecodeSubscription(msg, channel, data))
+            {
+                return;  // Subscription acks and other non-notification messages
+            }
+
+            std::cout << GetFormattedTimestamp() << " " << channel << "\n";
+
+            if (channel.compare(0, 7, "ticker.") == 0 && !ticker_handlers.empty())
+            {
+                if (!ResponseDecoder::DecodeTicker(data, ticker_buffer))
+                {
+                    std::cerr << GetFormattedTimestamp() << " Failed to parse ticker: " << channel << "\n";
+                    return;
+                }
+                for (const auto& handler : ticker_handlers)
+                {
+                    handler(ticker_buffer);
+                }
+            }
+            else if (channel.compare(0, 7, "trades.") == 0 && !trade_handlers.empty())
+            {
+                if (!ResponseDecoder::DecodeTrades(data, trades_buffer))
+                {
+                    std::cerr << GetFormattedTimestamp() << " Failed to parse trades: " << channel << "\n";
+                    return;
+                }
+                for (const auto& trade : trades_buffer)
+                {
+                    for (const auto& handler : trade_handlers)
+                    {
+                        handler(trade);
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << GetFormattedTimestamp() << " Exception processing message: " << e.what() << "\n";
+    }
+}
@@ -1,24 +1,44 @@
-#pragma once
-#include <memory>
-#include <string>
-
-#include <drogon/WebSocketClient.h>
-#include <json/json.h>
-
-class DrogonWebSocket
-{
-  private:
-    std::shared_ptr<drogon::WebSocketClient> ws_client;
-    std::string ws_symbol;
-    bool is_connected{false};
-
-    static std::string GetFormattedTimestamp();
-    void SubscribeToSymbol(const std::string& symbol);
-    void HandleMessage(std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
-                       const drogon::WebSocketMessageType& type);
-
-  public:
-    DrogonWebSocket();
-    ~DrogonWebSocket();
-    void ConnectToServer(const std::string& symbol);
-};
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <drogon/WebSocketClient.h>
+#include <json/json.h>
+
+#include "exchange_types.h"
+
+using TickerHandler = std::function<void(const Ticker& ticker)>;
+using TradeHandler = std::function<void(const Trade& trade)>;
+
+class DrogonWebSocket
+{
+    friend class WebSocketClientBenchmark;  // benchmarks/ drives HandleMessage without a connection
+
+  private:
+    std::shared_ptr<drogon::WebSocketClient> ws_client;
+    std::vector<std::string> ws_symbols;
+    bool is_connected{false};
+    std::vector<TickerHandler> ticker_handlers;
+    std::vector<TradeHandler> trade_handlers;
+    Ticker ticker_buffer;               // Reused across messages
+    std::vector<Trade> trades_buffer;  // Reused across messages
+
+    static std::string GetFormattedTimestamp();
+    void SubscribeToSymbols();
+    void HandleMessage(std::string&& msg, const drogon::WebSocketClientPtr& ws_ptr,
+                       const drogon::WebSocketMessageType& type);
+
+  public:
+    DrogonWebSocket();
+    ~DrogonWebSocket();
+    void ConnectToServer(const std::string& symbol);
+    // Subscribes every symbol over the one connection, e.g. a perpetual and all its dated futures
+    void ConnectToServer(const std::vector<std::string>& symbols);
+
+    // Handlers run on the WebSocket client's event loop; register them before connecting. The
+    // trades channel is only subscribed when at least one trade handler is registered.
+    void AddTickerHandler(TickerHandler handler);
+    void AddTradeHandler(TradeHandler handler);
+};